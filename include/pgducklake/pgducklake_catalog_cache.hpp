@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * pgducklake_catalog_cache.hpp — backend-local cache of DuckLake catalogs
+ *
+ * The catalog of a committed snapshot never changes, so the decoded
+ * DuckLakeCatalogInfo can be reused for as long as DuckLake asks for the same
+ * snapshot. A newer commit gets a new snapshot id and thus a new entry.
+ *
+ * Snapshot ids are only unique among committed snapshots: a transaction that
+ * writes metadata sees its own, not yet committed snapshot, whose id another
+ * backend may commit with different contents if we abort. Such transactions
+ * bypass the cache. Entries are also keyed by the ducklake_snapshot relation,
+ * so that recreating the extension, which restarts the ids, cannot hit stale
+ * entries.
+ */
+
+#include <duckdb/common/optional_idx.hpp>
+#include <duckdb/common/set.hpp>
+#include <duckdb/common/string.hpp>
+#include <duckdb/common/unique_ptr.hpp>
+#include <duckdb/main/query_result.hpp>
+#include <storage/ducklake_metadata_info.hpp>
+
+namespace pgducklake {
+
+class CatalogCache {
+public:
+  // Copy the cached catalog of `snapshot_id` into `catalog`, if any.
+  static bool Lookup(idx_t snapshot_id, const duckdb::string &data_path,
+                     duckdb::DuckLakeCatalogInfo &catalog);
+  // Copy the cached catalog of the latest snapshot before `snapshot_id` into
+  // `catalog`, if any, as a base for an incremental refresh.
+  static bool LookupPrevious(idx_t snapshot_id, const duckdb::string &data_path,
+                             idx_t &base_snapshot_id,
+                             duckdb::DuckLakeCatalogInfo &catalog);
+  static void Store(idx_t snapshot_id, const duckdb::string &data_path,
+                    const duckdb::DuckLakeCatalogInfo &catalog);
+};
+
+/*
+ * Backend-local copy of the tables of the catalog of one snapshot, by table
+ * id. Loading the catalog of a snapshot that is not in the CatalogCache then
+ * decodes only the tables with a metadata row created or ended between the
+ * two snapshots, and takes the others from here.
+ *
+ * DuckLake builds all table entries of a catalog up front, so tables cannot
+ * be loaded on first reference; this keeps a full load proportional to what
+ * changed instead. The cache moves forward with the loads of newer snapshots,
+ * which also drops the tables dropped in between. The same transactions as
+ * for CatalogCache bypass it.
+ */
+class TableInfoCache {
+public:
+  // The snapshot the cached tables are those of, if there are any for the
+  // current metadata.
+  static bool GetSnapshot(idx_t &snapshot_id);
+  // Append the cached tables, except those in `except_ids`, in id order
+  static void CopyTables(const duckdb::set<idx_t> &except_ids,
+                         duckdb::vector<duckdb::DuckLakeTableInfo> &tables);
+  // Make the cache hold the tables of `snapshot_id`: those in `changed_ids`
+  // are replaced by `tables`, or all of them if `changed_ids` is null.
+  static void Update(idx_t snapshot_id, const duckdb::set<idx_t> *changed_ids,
+                     const duckdb::vector<duckdb::DuckLakeTableInfo> &tables);
+};
+
+/*
+ * Backend-local cache of the file lists DuckLake reads to plan a scan: the
+ * results of metadata reads that only touch the data file, delete file and
+ * per-file statistics rows of a single table. Those rows are written once
+ * with their file and only ever get an end snapshot afterwards, so the rows a
+ * file contributes to such a result only change with the snapshots that add
+ * or remove the file or one of its delete files.
+ *
+ * An entry keeps the range of snapshots it is known to be valid for. Moving
+ * past it looks up the files that changed in between through the
+ * (table_id, begin_snapshot) and (table_id, end_snapshot) indexes; when the
+ * result has a data_file_id column, just the rows of those files are read
+ * again and replace theirs, otherwise the whole result is. Hits hand out a
+ * read-only view of the cached rows, which a later refresh never modifies.
+ *
+ * The entries of a backend take up to ducklake.file_list_cache_size. The same
+ * transactions as for CatalogCache bypass it.
+ */
+class FileListCache {
+public:
+  // Whether the current transaction may use the cache
+  static bool IsActive();
+  // Whether `query`, with catalog args filled in but snapshot placeholders
+  // still in place, is a file list read of a single table. Sets `table_id`.
+  static bool IsCacheable(const duckdb::string &query, idx_t &table_id);
+  // The cached result of `query` if it is valid at `snapshot_id`. Otherwise,
+  // if the cached result of an earlier snapshot can be brought up to date by
+  // reading the rows of a few data files again, set `file_column` to the
+  // result column that holds the data file id and `changed_files` to those
+  // files, and return null.
+  static duckdb::unique_ptr<duckdb::QueryResult>
+  Lookup(const duckdb::string &query, idx_t table_id, idx_t snapshot_id,
+         duckdb::optional_idx &file_column,
+         duckdb::set<idx_t> &changed_files);
+  // Replace the rows of `changed_files` in the cached result of `query` by
+  // `rows`, read at `snapshot_id`, and return the whole result. Null if the
+  // entry is gone.
+  static duckdb::unique_ptr<duckdb::QueryResult>
+  Refresh(const duckdb::string &query, idx_t table_id, idx_t snapshot_id,
+          const duckdb::set<idx_t> &changed_files,
+          duckdb::unique_ptr<duckdb::QueryResult> rows);
+  // Keep `result` as the result of `query` at `snapshot_id`, and return it
+  // (or a view of it, if it was moved into the cache).
+  static duckdb::unique_ptr<duckdb::QueryResult>
+  Store(const duckdb::string &query, idx_t table_id, idx_t snapshot_id,
+        duckdb::unique_ptr<duckdb::QueryResult> result);
+  // The queries of the cached file lists, most recently used first
+  static duckdb::vector<duckdb::string> GetQueries();
+};
+
+} // namespace pgducklake
@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ * pgducklake_metadata_batch.hpp — coalescing of DuckLake metadata writes
+ *
+ * A DuckLake commit hands the metadata manager one batch of ';'-separated
+ * statements, most of them single-row INSERTs into the ducklake_* tables.
+ * Run as-is, every INSERT is parsed, planned and executed on its own and
+ * bumps the command counter. The batch is rewritten so that runs of INSERTs
+ * into the same table with the same column list become one multi-row INSERT.
+ */
+
+#include <duckdb/common/string.hpp>
+#include <duckdb/common/unique_ptr.hpp>
+#include <duckdb/common/vector.hpp>
+#include <duckdb/main/query_result.hpp>
+
+namespace pgducklake {
+
+struct MetadataStatement {
+  // Statement text without the trailing ';'. For coalesced INSERTs, only the
+  // "INSERT INTO <target> [(<columns>)] VALUES " prefix; see `rows`.
+  duckdb::string text;
+  // Whether the statement is a coalescable "INSERT ... VALUES" statement.
+  bool is_insert = false;
+  // For INSERTs: the target table and the column list (including the
+  // parentheses, empty if absent), exactly as written in the statement.
+  duckdb::string target;
+  duckdb::string columns;
+  // For INSERTs: one "(...)" row per element, in statement order.
+  duckdb::vector<duckdb::string> rows;
+
+  duckdb::string ToSQL() const;
+};
+
+// Split `batch` into statements, merging consecutive INSERTs into the same
+// target and column list. Statements keep their order. Semicolons inside
+// literals, quoted identifiers and comments do not split.
+duckdb::vector<MetadataStatement>
+CoalesceMetadataBatch(const duckdb::string &batch);
+
+// Run a coalesced batch. INSERTs of literal rows are appended directly (see
+// pgducklake_metadata_insert.hpp), the statements in between go through SPI
+// together. Returns the result of the last statement.
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteMetadataBatch(const duckdb::vector<MetadataStatement> &statements);
+
+} // namespace pgducklake
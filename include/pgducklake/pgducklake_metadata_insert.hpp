@@ -0,0 +1,57 @@
+#pragma once
+
+/*
+ * pgducklake_metadata_insert.hpp — direct bulk inserts into metadata tables
+ *
+ * Coalesced metadata INSERTs whose rows are plain literals are turned into
+ * heap tuples and appended with table_multi_insert, skipping the parser,
+ * planner and executor.
+ */
+
+#include "pgducklake/pgducklake_metadata_batch.hpp"
+
+extern "C" {
+#include "postgres.h"
+
+#include "access/attnum.h"
+#include "utils/relcache.h"
+}
+
+namespace pgducklake {
+
+class DirectMetadataInsert {
+public:
+  // NULL, TRUE or FALSE, a number without or with a fraction or exponent,
+  // or a quoted string
+  enum class LiteralKind { NULL_VALUE, BOOL, INTEGER, DECIMAL, STRING };
+
+  struct LiteralValue {
+    LiteralKind kind = LiteralKind::NULL_VALUE;
+    // Text to feed to the column's input function
+    duckdb::string text;
+  };
+
+  // Check that the rows of `stmt` can be inserted directly, and parse them.
+  // Returns nullptr when the statement needs the regular executor:
+  // non-literal values, literals the executor would cast, an incomplete
+  // column list, or a target with triggers, rules, row security, CHECK
+  // constraints, deferrable or exclusion indexes, or without INSERT
+  // privilege.
+  static duckdb::unique_ptr<DirectMetadataInsert>
+  Prepare(const MetadataStatement &stmt);
+
+  ~DirectMetadataInsert();
+
+  // Append the rows and their index entries, then bump the command counter
+  // so that the following statements see them.
+  void Execute();
+
+private:
+  explicit DirectMetadataInsert(Relation rel);
+
+  Relation rel;
+  duckdb::vector<AttrNumber> attnums;
+  duckdb::vector<duckdb::vector<LiteralValue>> rows;
+};
+
+} // namespace pgducklake
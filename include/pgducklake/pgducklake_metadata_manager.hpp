@@ -2,6 +2,7 @@
 
 #include <common/ducklake_options.hpp>
 #include <common/ducklake_snapshot.hpp>
+#include <duckdb/common/set.hpp>
 #include <duckdb/common/unique_ptr.hpp>
 #include <storage/ducklake_metadata_info.hpp>
 #include <storage/ducklake_metadata_manager.hpp>
@@ -9,6 +10,8 @@
 
 namespace pgducklake {
 
+struct SnapshotParams;
+
 class PgDuckLakeMetadataManager : public duckdb::DuckLakeMetadataManager {
 public:
   explicit PgDuckLakeMetadataManager(duckdb::DuckLakeTransaction &transaction);
@@ -28,6 +31,10 @@ public:
   duckdb::unique_ptr<duckdb::QueryResult>
   Query(duckdb::DuckLakeSnapshot snapshot, duckdb::string query) override;
 
+  // The latest snapshot, as published in shared memory at commit, or read
+  // with a direct index scan
+  duckdb::unique_ptr<duckdb::DuckLakeSnapshot> GetSnapshot() override;
+
   static bool IsInitialized();
   bool IsInitialized(duckdb::DuckLakeOptions & /*options*/) override {
     return IsInitialized();
@@ -37,6 +44,8 @@ public:
   // them in PGSQL.
   duckdb::string CastStatsToTarget(const duckdb::string &stats,
                                    const duckdb::LogicalType &type) override;
+  // Served from the CatalogCache when possible, or patched from the cached
+  // catalog of an older snapshot
   duckdb::DuckLakeCatalogInfo
   GetCatalogForSnapshot(duckdb::DuckLakeSnapshot snapshot) override;
 
@@ -49,6 +58,54 @@ protected:
   duckdb::string WrapWithListAggregation(
       const duckdb::vector<std::pair<duckdb::string, duckdb::string>> &fields)
       const override;
+
+  // Like Query(snapshot, query) for a single SELECT, but the result streams
+  // from an SPI cursor instead of being materialized. Only for callers that
+  // iterate the result once, within the current transaction. `params`, made
+  // for `snapshot`, carries values the query references as $5 onwards.
+  duckdb::unique_ptr<duckdb::QueryResult>
+  StreamQuery(duckdb::DuckLakeSnapshot snapshot, duckdb::string query,
+              const SnapshotParams *params = nullptr);
+
+private:
+  // Read the catalog of `snapshot` from the metadata tables
+  duckdb::DuckLakeCatalogInfo
+  LoadCatalogForSnapshot(duckdb::DuckLakeSnapshot snapshot);
+  // Append all schemas and the tables, views and partitions (by table) of
+  // the given ids, through ducklake._catalog_for_snapshot(); a null id set
+  // loads all objects of its kind.
+  void LoadCatalog(duckdb::DuckLakeSnapshot snapshot,
+                   duckdb::DuckLakeCatalogInfo &catalog,
+                   const duckdb::set<idx_t> *table_ids,
+                   const duckdb::set<idx_t> *view_ids,
+                   const duckdb::set<idx_t> *partition_table_ids);
+  // Ids of the objects that differ between two snapshots
+  struct CatalogChanges {
+    duckdb::set<idx_t> schema_ids;
+    duckdb::set<idx_t> table_ids;
+    duckdb::set<idx_t> view_ids;
+    duckdb::set<idx_t> partition_table_ids;
+  };
+  void LoadCatalogChanges(duckdb::DuckLakeSnapshot snapshot,
+                          idx_t from_snapshot_id, idx_t to_snapshot_id,
+                          CatalogChanges &changes);
+  // Patch the catalog of `base_snapshot_id` into that of `snapshot`
+  void RefreshCatalog(idx_t base_snapshot_id, duckdb::DuckLakeSnapshot snapshot,
+                      duckdb::DuckLakeCatalogInfo &catalog);
+  void RefreshInlinedDataTables(duckdb::DuckLakeSnapshot snapshot,
+                                duckdb::DuckLakeCatalogInfo &catalog);
+
+  duckdb::unique_ptr<duckdb::QueryResult>
+  RunQuery(duckdb::DuckLakeSnapshot snapshot, duckdb::string query,
+           bool stream, const SnapshotParams *extra_params);
+  // A file list read of table `table_id`, through the FileListCache
+  duckdb::unique_ptr<duckdb::QueryResult>
+  QueryFileList(duckdb::DuckLakeSnapshot snapshot, const duckdb::string &query,
+                idx_t table_id);
+  // RunQuery() once the catalog args are filled in
+  duckdb::unique_ptr<duckdb::QueryResult>
+  ExecuteRead(duckdb::DuckLakeSnapshot snapshot, duckdb::string query,
+              bool stream, const SnapshotParams *extra_params);
 };
 
 } // namespace pgducklake
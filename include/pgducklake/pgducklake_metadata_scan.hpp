@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ * pgducklake_metadata_scan.hpp — direct scans of the DuckLake metadata tables
+ *
+ * The lookups DuckLake makes at the start of almost every statement fetch a
+ * handful of rows by key. Going through SPI costs a parse/plan cycle and an
+ * executor startup for each; these helpers read the rows with
+ * systable_beginscan on the table's index instead, using the metadata read
+ * snapshot of the transaction.
+ *
+ * All functions return false (or null) when the metadata tables do not
+ * exist, so callers can fall back to the regular queries.
+ */
+
+#include <common/ducklake_snapshot.hpp>
+#include <duckdb/common/optional_idx.hpp>
+#include <duckdb/common/set.hpp>
+#include <duckdb/main/query_result.hpp>
+
+extern "C" {
+#include "postgres.h"
+}
+
+namespace pgducklake {
+
+// The snapshot with the highest id.
+bool ScanLatestSnapshot(duckdb::DuckLakeSnapshot &snapshot);
+
+// The snapshot with the highest id committed as of now, regardless of the
+// snapshot of the transaction, and the transaction that wrote it.
+bool ScanLatestCommittedSnapshot(duckdb::DuckLakeSnapshot &snapshot,
+                                 TransactionId &xmin);
+
+// Add to `data_file_ids` the data files of table `table_id` that were added or
+// removed, or got a delete file added or removed, by a snapshot in
+// (from_snapshot, to_snapshot].
+bool ScanTableFilesChanged(idx_t table_id, idx_t from_snapshot,
+                           idx_t to_snapshot,
+                           duckdb::set<idx_t> &data_file_ids);
+
+// Answer `query`, a DuckLake read with its catalog filled in, by an index
+// scan if it is a point lookup of the form
+//
+//   SELECT <columns> FROM <schema>.ducklake_<table> WHERE <key> = <id>
+//
+// optionally followed by the usual "AND {SNAPSHOT_ID} >= begin_snapshot AND
+// ({SNAPSHOT_ID} < end_snapshot OR end_snapshot IS NULL)", which is evaluated
+// at `snapshot_id`. Null for any other query, when `key` has no bigint index,
+// or when the table is not plainly readable by the current user.
+duckdb::unique_ptr<duckdb::QueryResult>
+ScanPointLookup(const duckdb::string &query,
+                duckdb::optional_idx snapshot_id = duckdb::optional_idx());
+
+} // namespace pgducklake
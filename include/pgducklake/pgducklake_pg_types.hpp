@@ -6,6 +6,7 @@
 
 #include "duckdb/common/types/vector.hpp"
 #include "duckdb/common/types.hpp"
+#include "duckdb/common/unordered_map.hpp"
 
 extern "C" {
 #include "postgres.h"
@@ -21,7 +22,87 @@ Datum DetoastPostgresDatum(struct varlena *attr, bool *should_free);
 // Convert PostgreSQL Datum value to DuckDB Vector at the given offset
 void ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &result, uint64_t offset);
 
+// Convert a PostgreSQL type to a DuckDB LogicalType: arrays become LIST,
+// composite types STRUCT, enums ENUM and numerics with a typmod DECIMAL.
+// Returns SQLNULL for unsupported types, and for anonymous records whose row
+// type is not known from `typmod`.
+duckdb::LogicalType ConvertPostgresToDuckType(Oid typid, int32 typmod);
+
+// The DuckDB type of a DuckLake table column of PostgreSQL type `typid`: as
+// ConvertPostgresToDuckType(), but with enums as VARCHAR, since DuckLake has
+// no ENUM columns.
+duckdb::LogicalType ConvertPostgresToDuckLakeType(Oid typid, int32 typmod);
+
 // Convert PostgreSQL column attribute to DuckDB LogicalType
 duckdb::LogicalType ConvertPostgresToDuckColumnType(Form_pg_attribute &attribute);
 
+// Converts whole batches of one result column. The conversion kernel is picked
+// once from the column type, so the per-value work is a tight loop without a
+// type switch.
+//
+// With `reference_strings`, plain and short-header text and bytea values are
+// not copied: the strings in `result` point into the datums themselves. The
+// caller must then copy the chunk, e.g. by appending it to a
+// ColumnDataCollection, before the tuples are freed.
+class PostgresColumnConverter {
+public:
+  explicit PostgresColumnConverter(Form_pg_attribute attribute,
+                                   bool reference_strings = false);
+
+  const duckdb::LogicalType &GetType() const { return type; }
+
+  // Convert `count` datums of this column into `result`. Null rows must
+  // already be marked invalid in `result`; their datums are ignored.
+  void Convert(const Datum *values, const bool *nulls, idx_t count,
+               duckdb::Vector &result) const {
+    convert(*this, values, nulls, count, result);
+  }
+
+private:
+  using ConvertFunction = void (*)(const PostgresColumnConverter &converter,
+                                   const Datum *values, const bool *nulls,
+                                   idx_t count, duckdb::Vector &result);
+
+  template <class OP>
+  static void ConvertFixedColumn(const PostgresColumnConverter &converter,
+                                 const Datum *values, const bool *nulls,
+                                 idx_t count, duckdb::Vector &result);
+  static void ConvertDateColumn(const PostgresColumnConverter &converter,
+                                const Datum *values, const bool *nulls,
+                                idx_t count, duckdb::Vector &result);
+  static void ConvertTimestampColumn(const PostgresColumnConverter &converter,
+                                     const Datum *values, const bool *nulls,
+                                     idx_t count, duckdb::Vector &result);
+  static void ConvertUUIDColumn(const PostgresColumnConverter &converter,
+                                const Datum *values, const bool *nulls,
+                                idx_t count, duckdb::Vector &result);
+  static void ConvertDecimalColumn(const PostgresColumnConverter &converter,
+                                   const Datum *values, const bool *nulls,
+                                   idx_t count, duckdb::Vector &result);
+  template <class T>
+  static void ConvertEnumColumn(const PostgresColumnConverter &converter,
+                                const Datum *values, const bool *nulls,
+                                idx_t count, duckdb::Vector &result);
+  static void ConvertTextColumn(const PostgresColumnConverter &converter,
+                                const Datum *values, const bool *nulls,
+                                idx_t count, duckdb::Vector &result);
+  static void ConvertJsonbColumn(const PostgresColumnConverter &converter,
+                                 const Datum *values, const bool *nulls,
+                                 idx_t count, duckdb::Vector &result);
+  static void ConvertGenericColumn(const PostgresColumnConverter &converter,
+                                   const Datum *values, const bool *nulls,
+                                   idx_t count, duckdb::Vector &result);
+  static void ConvertNestedColumn(const PostgresColumnConverter &converter,
+                                  const Datum *values, const bool *nulls,
+                                  idx_t count, duckdb::Vector &result);
+
+  Oid type_oid;
+  int16 type_len;
+  bool reference_strings;
+  duckdb::LogicalType type;
+  ConvertFunction convert;
+  // For enum columns: the DuckDB enum value of every pg_enum OID
+  duckdb::unordered_map<Oid, uint32_t> enum_positions;
+};
+
 } // namespace pgducklake
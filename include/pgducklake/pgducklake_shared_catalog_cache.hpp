@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+ * pgducklake_shared_catalog_cache.hpp — catalog cache shared by all backends
+ *
+ * With pg_ducklake in shared_preload_libraries, decoded catalogs of recent
+ * snapshots are also kept, serialized, in a shared memory arena of
+ * ducklake.shared_catalog_cache_size, so that a new backend finds the catalog
+ * without running the catalog queries. Each catalog takes as much of the
+ * arena as it needs, and the least recently used ones make room for new
+ * ones; only a catalog larger than the whole arena is not shared.
+ *
+ * Keys are the same as for the backend-local CatalogCache, plus the
+ * database, and the same rules apply as to which transactions may use it.
+ */
+
+#include <duckdb/common/string.hpp>
+#include <storage/ducklake_metadata_info.hpp>
+
+extern "C" {
+#include "postgres.h"
+}
+
+namespace pgducklake {
+
+class SharedCatalogCache {
+public:
+  // Whether the shared memory arena was set up at postmaster start.
+  static bool IsEnabled();
+
+  static bool Lookup(Oid snapshot_relid, idx_t snapshot_id,
+                     const duckdb::string &data_path,
+                     duckdb::DuckLakeCatalogInfo &catalog);
+  static void Store(Oid snapshot_relid, idx_t snapshot_id,
+                    const duckdb::string &data_path,
+                    const duckdb::DuckLakeCatalogInfo &catalog);
+};
+
+} // namespace pgducklake
@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+ * pgducklake_shared_snapshot.hpp — latest DuckLake snapshot in shared memory
+ *
+ * DuckLake asks for the latest snapshot at the start of every transaction
+ * that touches a DuckLake table. With pg_ducklake in shared_preload_libraries,
+ * the latest committed snapshot of each metadata catalog is kept in shared
+ * memory instead: a row trigger on ducklake_snapshot notes the snapshot a
+ * transaction writes, whoever the writer is, and the backend publishes it
+ * once the transaction has committed.
+ *
+ * A published snapshot is only used by a transaction whose snapshot sees the
+ * commit that wrote it, and never while a transaction that wrote a newer one
+ * is still between its INSERT and the publication. Anything else reads
+ * ducklake_snapshot as before. After a restart, the first lookup of a catalog
+ * fills its slot with a scan as of the current instant.
+ */
+
+#include <common/ducklake_snapshot.hpp>
+
+namespace pgducklake {
+
+class SharedLatestSnapshot {
+public:
+  // Whether the shared memory state was set up at postmaster start.
+  static bool IsEnabled();
+
+  // The latest snapshot of the current metadata, if it was published and
+  // this transaction may use it.
+  static bool Lookup(duckdb::DuckLakeSnapshot &snapshot);
+};
+
+} // namespace pgducklake
@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * pgducklake_spi.hpp — DuckLake metadata queries executed through SPI
+ *
+ * Results are returned either fully materialized, or backed by an SPI cursor
+ * that converts one STANDARD_VECTOR_SIZE batch at a time as DuckDB pulls
+ * chunks from it.
+ */
+
+#include <common/ducklake_snapshot.hpp>
+#include <duckdb/common/set.hpp>
+#include <duckdb/common/unique_ptr.hpp>
+#include <duckdb/main/query_result.hpp>
+
+extern "C" {
+#include "postgres.h"
+
+#include "utils/snapshot.h"
+}
+
+namespace pgducklake {
+
+// Snapshot placeholders of DuckLake query templates. Read queries bind them
+// as parameters of a cached prepared plan instead of splicing the values into
+// the query text, so the same template is parsed and planned once per backend.
+constexpr int NUM_SNAPSHOT_PARAMS = 4;
+// Further values our own queries bind after the snapshot, as $5 onwards
+constexpr int MAX_EXTRA_PARAMS = 3;
+
+struct SnapshotParams {
+  int num_params;
+  Oid types[NUM_SNAPSHOT_PARAMS + MAX_EXTRA_PARAMS];
+  Datum values[NUM_SNAPSHOT_PARAMS + MAX_EXTRA_PARAMS];
+
+  explicit SnapshotParams(const duckdb::DuckLakeSnapshot &snapshot);
+
+  // Bind a bigint, or a bigint[] of `ids`, as the next parameter, and return
+  // its reference for the query text ("$5", ...).
+  duckdb::string AddBigint(int64 value);
+  duckdb::string AddBigintArray(const duckdb::set<idx_t> &ids);
+};
+
+// Whether `query` starts with SELECT or WITH.
+bool IsSelectQuery(const duckdb::string &query);
+
+// Replace the snapshot placeholders in `query` by $1..$4. Returns false and
+// leaves `query` untouched if there is nothing to bind, or if a placeholder
+// appears inside a quoted literal where it cannot become a parameter.
+bool ParameterizeSnapshotArgs(duckdb::string &query);
+
+// The snapshot shared by the metadata reads of the current DuckLake
+// transaction, taken on first use.
+Snapshot GetMetadataReadSnapshot();
+
+// Bracket a DuckLake transaction: the shared metadata read snapshot is
+// dropped when the last one ends, and at the end of the PostgreSQL
+// transaction in any case.
+void BeginMetadataReadScope();
+void EndMetadataReadScope();
+
+// Push a copy of the snapshot shared by the metadata reads of the current
+// DuckLake transaction, with the command id advanced so that metadata written earlier
+// in the transaction is visible. Pop it with PopActiveSnapshot().
+void PushMetadataReadSnapshot();
+
+// An empty result, as returned for a statement with SPI result code
+// `spi_result` (e.g. SPI_OK_INSERT).
+duckdb::unique_ptr<duckdb::QueryResult> EmptySPIResult(int spi_result);
+
+// Run `query`, which may write, and materialize its whole result.
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteSPIQuery(const duckdb::string &query,
+                const SnapshotParams *params = nullptr);
+
+// Like ExecuteSPIQuery, but for metadata reads: plain SELECTs run through
+// read-only SPI on a snapshot shared across the DuckLake transaction, without
+// the command-id bookkeeping writes need. Anything else falls back to
+// ExecuteSPIQuery.
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteSPIRead(const duckdb::string &query,
+               const SnapshotParams *params = nullptr);
+
+// Open `query` as a read-only SPI cursor. The returned result fetches and
+// converts rows batch by batch, and must be consumed within the current
+// transaction. Anything but a single read-only SELECT is materialized through
+// ExecuteSPIRead instead.
+duckdb::unique_ptr<duckdb::QueryResult>
+OpenSPICursor(const duckdb::string &query,
+              const SnapshotParams *params = nullptr);
+
+} // namespace pgducklake
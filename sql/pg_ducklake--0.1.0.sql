@@ -2,6 +2,17 @@ CREATE SCHEMA ducklake;
 
 GRANT USAGE ON SCHEMA ducklake TO PUBLIC;
 
+-- Row types of the tag and inlined table lists read by the metadata manager
+CREATE TYPE ducklake._tag AS (
+    key varchar,
+    value varchar
+);
+
+CREATE TYPE ducklake._inlined_table AS (
+    name varchar,
+    schema_version bigint
+);
+
 -- Table Access Method
 CREATE FUNCTION ducklake._am_handler(internal)
     RETURNS table_am_handler
@@ -33,6 +44,84 @@ CREATE FUNCTION ducklake._drop_trigger()
 CREATE EVENT TRIGGER ducklake_drop_trigger ON sql_drop
     EXECUTE FUNCTION ducklake._drop_trigger();
 
+-- Shared catalog cache statistics
+CREATE FUNCTION ducklake._catalog_cache_stats(
+    OUT enabled boolean,
+    OUT hits bigint,
+    OUT misses bigint,
+    OUT stores bigint,
+    OUT skipped_stores bigint,
+    OUT entries int)
+    RETURNS record
+    AS 'MODULE_PATHNAME', 'ducklake_catalog_cache_stats'
+    LANGUAGE C;
+
+CREATE VIEW ducklake.catalog_cache_stats AS
+    SELECT * FROM ducklake._catalog_cache_stats();
+
+-- How many catalogs this backend patched from a cached one, and how many it
+-- read in full. For tests.
+CREATE FUNCTION ducklake._catalog_loads(
+    OUT refreshes bigint,
+    OUT full_loads bigint)
+    RETURNS record
+    AS 'MODULE_PATHNAME', 'ducklake_catalog_loads'
+    LANGUAGE C;
+
+-- How many file lists this backend took from its cache as they were, patched
+-- with the rows of the files that changed, and read in full. For tests.
+CREATE FUNCTION ducklake._file_list_loads(
+    OUT hits bigint,
+    OUT refreshes bigint,
+    OUT full_reads bigint)
+    RETURNS record
+    AS 'MODULE_PATHNAME', 'ducklake_file_list_loads'
+    LANGUAGE C;
+
+-- The reads the metadata manager plans, as it binds them: snapshot values as
+-- $1 to $4, further values from $5 on. For tests.
+CREATE FUNCTION ducklake._metadata_read_queries()
+    RETURNS TABLE (name text, query text)
+    AS 'MODULE_PATHNAME', 'ducklake_metadata_read_queries'
+    LANGUAGE C;
+
+-- How the metadata manager runs a batch of metadata writes: the statements
+-- left after coalescing, and whether each is appended directly. For tests;
+-- nothing is executed.
+CREATE FUNCTION ducklake._explain_metadata_batch(text)
+    RETURNS TABLE (statement text, direct boolean)
+    AS 'MODULE_PATHNAME', 'ducklake_explain_metadata_batch'
+    LANGUAGE C STRICT;
+
+-- Runs a batch of metadata writes as a DuckLake commit does. For tests.
+CREATE FUNCTION ducklake._execute_metadata_batch(text)
+    RETURNS void
+    AS 'MODULE_PATHNAME', 'ducklake_execute_metadata_batch'
+    LANGUAGE C STRICT;
+
+-- Every value of the result of a query as DuckDB receives it from the
+-- metadata tables: column name, DuckDB type and value. For tests.
+CREATE FUNCTION ducklake._convert_metadata_result(text)
+    RETURNS TABLE (name text, type text, value text)
+    AS 'MODULE_PATHNAME', 'ducklake_convert_metadata_result'
+    LANGUAGE C STRICT;
+
+-- How many metadata reads this backend ran from a cached plan, and how many
+-- plans it prepared. For tests.
+CREATE FUNCTION ducklake._plan_cache_stats(
+    OUT hits bigint,
+    OUT prepares bigint)
+    RETURNS record
+    AS 'MODULE_PATHNAME', 'ducklake_plan_cache_stats'
+    LANGUAGE C;
+
+-- Notes snapshots written to ducklake.ducklake_snapshot, so that they are
+-- published in shared memory at commit. Attached by initialization.
+CREATE FUNCTION ducklake._snapshot_written()
+    RETURNS trigger
+    AS 'MODULE_PATHNAME', 'ducklake_snapshot_written'
+    LANGUAGE C;
+
 -- Initialization function
 CREATE FUNCTION ducklake._initialize()
     RETURNS void
@@ -46,3 +135,191 @@ BEGIN
     PERFORM ducklake._initialize();
 END
 $$;
+
+-- The catalog of a snapshot in one result, the only way the metadata manager
+-- reads it: schemas, tables, columns, views and partition fields, in that
+-- order (section 0 to 4). Given id arrays restrict tables (with their
+-- columns), views and partitions (by table) to those ids, for refreshes of a
+-- cached catalog; schemas are always all returned. Defined after
+-- initialization, which creates the tables it reads.
+--
+-- At the latest snapshot, the live rows are exactly those that have not
+-- ended yet, which the partial "end_snapshot IS NULL" indexes find without
+-- going through the history; only older snapshots use the range predicate,
+-- whose rows ending after the snapshot the end_snapshot indexes find.
+CREATE FUNCTION ducklake._catalog_for_snapshot(
+        snapshot_id bigint,
+        table_ids bigint[] DEFAULT NULL,
+        view_ids bigint[] DEFAULT NULL,
+        partition_table_ids bigint[] DEFAULT NULL)
+    RETURNS TABLE (
+        section int,
+        id bigint,
+        parent_id bigint,
+        uuid varchar,
+        name varchar,
+        path varchar,
+        path_is_relative boolean,
+        tags ducklake._tag[],
+        inlined_data_tables ducklake._inlined_table[],
+        column_type varchar,
+        initial_default varchar,
+        default_value varchar,
+        nulls_allowed boolean,
+        parent_column bigint,
+        dialect varchar,
+        sql varchar,
+        column_aliases varchar,
+        partition_key_index bigint,
+        field_id bigint,
+        transform varchar)
+    LANGUAGE sql STABLE
+    AS $$
+WITH latest AS (
+    SELECT $1 = (SELECT max(snapshot_id) FROM ducklake.ducklake_snapshot)
+        AS is_latest
+), sch AS (
+    SELECT * FROM ducklake.ducklake_schema
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_schema
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+), tbl AS (
+    SELECT * FROM ducklake.ducklake_table
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($2 IS NULL OR table_id = ANY($2))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_table
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($2 IS NULL OR table_id = ANY($2))
+), col AS (
+    SELECT * FROM ducklake.ducklake_column
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($2 IS NULL OR table_id = ANY($2))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_column
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($2 IS NULL OR table_id = ANY($2))
+), tag AS (
+    -- tags of tables and views alike
+    SELECT * FROM ducklake.ducklake_tag
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($2 IS NULL OR $3 IS NULL
+           OR object_id = ANY($2) OR object_id = ANY($3))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_tag
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($2 IS NULL OR $3 IS NULL
+           OR object_id = ANY($2) OR object_id = ANY($3))
+), col_tag AS (
+    SELECT * FROM ducklake.ducklake_column_tag
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($2 IS NULL OR table_id = ANY($2))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_column_tag
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($2 IS NULL OR table_id = ANY($2))
+), vw AS (
+    SELECT * FROM ducklake.ducklake_view
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($3 IS NULL OR view_id = ANY($3))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_view
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($3 IS NULL OR view_id = ANY($3))
+), part AS (
+    SELECT * FROM ducklake.ducklake_partition_info
+    WHERE end_snapshot IS NULL AND (SELECT is_latest FROM latest)
+      AND ($4 IS NULL OR table_id = ANY($4))
+    UNION ALL
+    SELECT * FROM ducklake.ducklake_partition_info
+    WHERE NOT (SELECT is_latest FROM latest)
+      AND $1 >= begin_snapshot AND ($1 < end_snapshot OR end_snapshot IS NULL)
+      AND ($4 IS NULL OR table_id = ANY($4))
+), object_tags AS (
+    SELECT object_id, array_agg(ROW(key, value)::ducklake._tag) AS tags
+    FROM tag
+    GROUP BY object_id
+), column_tags AS (
+    SELECT table_id, column_id,
+           array_agg(ROW(key, value)::ducklake._tag) AS tags
+    FROM col_tag
+    GROUP BY table_id, column_id
+), inlined AS (
+    -- Inlined data tables carry no snapshot range, but the schema version
+    -- they were created for: later ones did not exist yet at $1
+    SELECT table_id,
+           array_agg(ROW(table_name, schema_version)::ducklake._inlined_table)
+               AS inlined_data_tables
+    FROM ducklake.ducklake_inlined_data_tables
+    WHERE schema_version <= (SELECT schema_version
+                             FROM ducklake.ducklake_snapshot
+                             WHERE snapshot_id = $1)
+      AND ($2 IS NULL OR table_id = ANY($2))
+    GROUP BY table_id
+)
+SELECT section, id, parent_id, uuid, name, path, path_is_relative, tags,
+       inlined_data_tables, column_type, initial_default, default_value,
+       nulls_allowed, parent_column, dialect, sql, column_aliases,
+       partition_key_index, field_id, transform
+FROM (
+    SELECT 0 AS section, schema_id AS id, NULL::bigint AS parent_id,
+           schema_uuid::varchar AS uuid, schema_name::varchar AS name,
+           path::varchar AS path, path_is_relative,
+           NULL::ducklake._tag[] AS tags,
+           NULL::ducklake._inlined_table[] AS inlined_data_tables,
+           NULL::varchar AS column_type,
+           NULL::varchar AS initial_default, NULL::varchar AS default_value,
+           NULL::boolean AS nulls_allowed, NULL::bigint AS parent_column,
+           NULL::varchar AS dialect, NULL::varchar AS sql,
+           NULL::varchar AS column_aliases,
+           NULL::bigint AS partition_key_index, NULL::bigint AS field_id,
+           NULL::varchar AS transform,
+           schema_id AS sort1, 0::bigint AS sort2, 0::bigint AS sort3
+    FROM sch
+    UNION ALL
+    SELECT 1, tbl.table_id, tbl.schema_id, tbl.table_uuid::varchar,
+           tbl.table_name::varchar, tbl.path::varchar, tbl.path_is_relative,
+           object_tags.tags, inlined.inlined_data_tables, NULL, NULL, NULL,
+           NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+           tbl.table_id, 0, 0
+    FROM tbl
+    LEFT JOIN object_tags ON object_tags.object_id = tbl.table_id
+    LEFT JOIN inlined ON inlined.table_id = tbl.table_id
+    UNION ALL
+    SELECT 2, col.column_id, col.table_id, NULL, col.column_name::varchar,
+           NULL, NULL, column_tags.tags, NULL,
+           col.column_type::varchar, col.initial_default::varchar,
+           col.default_value::varchar, col.nulls_allowed, col.parent_column,
+           NULL, NULL, NULL, NULL, NULL, NULL,
+           col.table_id, COALESCE(col.parent_column, -1), col.column_order
+    FROM col
+    JOIN tbl USING (table_id)
+    LEFT JOIN column_tags
+        ON column_tags.table_id = col.table_id
+       AND column_tags.column_id = col.column_id
+    UNION ALL
+    SELECT 3, vw.view_id, vw.schema_id, vw.view_uuid::varchar,
+           vw.view_name::varchar, NULL, NULL, object_tags.tags, NULL,
+           NULL, NULL, NULL, NULL, NULL, vw.dialect::varchar,
+           vw.sql::varchar, vw.column_aliases::varchar, NULL, NULL, NULL,
+           vw.view_id, 0, 0
+    FROM vw
+    LEFT JOIN object_tags ON object_tags.object_id = vw.view_id
+    UNION ALL
+    SELECT 4, part.partition_id, part.table_id, NULL, NULL, NULL, NULL, NULL,
+           NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+           part_col.partition_key_index, part_col.column_id,
+           part_col.transform::varchar,
+           part.table_id, part.partition_id, part_col.partition_key_index
+    FROM part
+    JOIN ducklake.ducklake_partition_column part_col USING (partition_id)
+) catalog
+ORDER BY section, sort1, sort2, sort3
+$$;
@@ -17,6 +17,9 @@ PG_MODULE_MAGIC;
 
 // Forward declaration of C interface functions
 void ducklake_init_extension(void);
+void ducklake_init_shared_catalog_cache(void);
+void ducklake_init_shared_latest_snapshot(void);
+void ducklake_init_file_list_cache(void);
 void ducklake_load_extension(void *db, void *context);
 
 typedef void (*DuckDBLoadExtension)(void *db, void *context);
@@ -25,6 +28,12 @@ bool RegisterDuckdbLoadExtension(DuckDBLoadExtension extension);
 void _PG_init(void) {
   // Register the DuckLake metadata manager (eager, no DuckDB instance needed)
   ducklake_init_extension();
+  // Shared memory catalog cache, only set up when preloaded
+  ducklake_init_shared_catalog_cache();
+  // Latest snapshot published at commit, likewise
+  ducklake_init_shared_latest_snapshot();
+  // Backend-local file list cache size
+  ducklake_init_file_list_cache();
   // Register callback for deferred static extension loading
   RegisterDuckdbLoadExtension(ducklake_load_extension);
 }
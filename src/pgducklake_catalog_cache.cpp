@@ -0,0 +1,591 @@
+#include "pgducklake/pgducklake_catalog_cache.hpp"
+
+#include "pgducklake/pgducklake_metadata_scan.hpp"
+#include "pgducklake/pgducklake_shared_catalog_cache.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/namespace.h"
+#include "miscadmin.h"
+#include "utils/acl.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+}
+
+#include <duckdb/common/map.hpp>
+#include <duckdb/common/shared_ptr.hpp>
+#include <duckdb/common/types/column/column_data_collection.hpp>
+#include <duckdb/common/unordered_map.hpp>
+#include <duckdb/main/materialized_query_result.hpp>
+#include <cctype>
+#include <cstring>
+#include <initializer_list>
+#include <list>
+
+namespace pgducklake {
+
+// A handful of snapshots is enough: readers mostly want the latest one, and
+// long-running transactions the one they started with.
+constexpr size_t CATALOG_CACHE_MAX_ENTRIES = 8;
+
+struct CatalogCacheEntry {
+  Oid snapshot_relid;
+  idx_t snapshot_id;
+  duckdb::string data_path;
+  duckdb::DuckLakeCatalogInfo catalog;
+};
+
+// Most recently used first
+static std::list<CatalogCacheEntry> catalog_cache;
+
+// The cache key of the current metadata, or InvalidOid if the cache must not
+// be used by this transaction
+static Oid CacheableSnapshotRelid() {
+  if (TransactionIdIsValid(GetTopTransactionIdIfAny())) {
+    return InvalidOid;
+  }
+  Oid nspoid = get_namespace_oid("ducklake", true);
+  if (!OidIsValid(nspoid)) {
+    return InvalidOid;
+  }
+  return get_relname_relid("ducklake_snapshot", nspoid);
+}
+
+/*
+ * Whether the current user may read the metadata tables `relnames`. Cached
+ * results were read with the privileges of whoever loaded them, possibly in
+ * another backend or under another role, so a hit must make the checks the
+ * queries it stands for would have made.
+ */
+static bool CanReadMetadata(std::initializer_list<const char *> relnames) {
+  Oid nspoid = get_namespace_oid("ducklake", true);
+  if (!OidIsValid(nspoid) ||
+      pg_namespace_aclcheck(nspoid, GetUserId(), ACL_USAGE) != ACLCHECK_OK) {
+    return false;
+  }
+  for (auto relname : relnames) {
+    Oid relid = get_relname_relid(relname, nspoid);
+    if (!OidIsValid(relid) ||
+        pg_class_aclcheck(relid, GetUserId(), ACL_SELECT) != ACLCHECK_OK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The tables a catalog is loaded from
+static bool CanReadCatalog() {
+  return CanReadMetadata(
+      {"ducklake_snapshot", "ducklake_schema", "ducklake_table",
+       "ducklake_column", "ducklake_tag", "ducklake_column_tag",
+       "ducklake_view", "ducklake_partition_info", "ducklake_partition_column",
+       "ducklake_inlined_data_tables"});
+}
+
+static void StoreLocal(Oid relid, idx_t snapshot_id,
+                       const duckdb::string &data_path,
+                       const duckdb::DuckLakeCatalogInfo &catalog) {
+  // Entries of a dropped catalog can never be hit again
+  catalog_cache.remove_if([relid](const CatalogCacheEntry &entry) {
+    return entry.snapshot_relid != relid;
+  });
+  if (catalog_cache.size() >= CATALOG_CACHE_MAX_ENTRIES) {
+    catalog_cache.pop_back();
+  }
+  catalog_cache.push_front(
+      CatalogCacheEntry{relid, snapshot_id, data_path, catalog});
+}
+
+bool CatalogCache::Lookup(idx_t snapshot_id, const duckdb::string &data_path,
+                          duckdb::DuckLakeCatalogInfo &catalog) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid) || !CanReadCatalog()) {
+    return false;
+  }
+  for (auto it = catalog_cache.begin(); it != catalog_cache.end(); ++it) {
+    if (it->snapshot_relid == relid && it->snapshot_id == snapshot_id &&
+        it->data_path == data_path) {
+      catalog_cache.splice(catalog_cache.begin(), catalog_cache, it);
+      catalog = it->catalog;
+      return true;
+    }
+  }
+  if (!SharedCatalogCache::Lookup(relid, snapshot_id, data_path, catalog)) {
+    return false;
+  }
+  StoreLocal(relid, snapshot_id, data_path, catalog);
+  return true;
+}
+
+bool CatalogCache::LookupPrevious(idx_t snapshot_id,
+                                  const duckdb::string &data_path,
+                                  idx_t &base_snapshot_id,
+                                  duckdb::DuckLakeCatalogInfo &catalog) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid) || !CanReadCatalog()) {
+    return false;
+  }
+  const CatalogCacheEntry *base = nullptr;
+  for (auto &entry : catalog_cache) {
+    if (entry.snapshot_relid == relid && entry.snapshot_id < snapshot_id &&
+        entry.data_path == data_path &&
+        (!base || entry.snapshot_id > base->snapshot_id)) {
+      base = &entry;
+    }
+  }
+  if (!base) {
+    return false;
+  }
+  base_snapshot_id = base->snapshot_id;
+  catalog = base->catalog;
+  return true;
+}
+
+void CatalogCache::Store(idx_t snapshot_id, const duckdb::string &data_path,
+                         const duckdb::DuckLakeCatalogInfo &catalog) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid)) {
+    return;
+  }
+  StoreLocal(relid, snapshot_id, data_path, catalog);
+  SharedCatalogCache::Store(relid, snapshot_id, data_path, catalog);
+}
+
+// Catalogs with more tables than this are not kept table by table: a load of
+// their catalog goes through the catalog query, as without this cache.
+constexpr size_t TABLE_INFO_CACHE_MAX_TABLES = 100000;
+
+// The tables of snapshot table_info_snapshot of the metadata of
+// table_info_relid, by table id
+static Oid table_info_relid = InvalidOid;
+static idx_t table_info_snapshot = 0;
+static duckdb::map<idx_t, duckdb::DuckLakeTableInfo> table_info_cache;
+
+bool TableInfoCache::GetSnapshot(idx_t &snapshot_id) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid) || relid != table_info_relid ||
+      table_info_cache.empty()) {
+    return false;
+  }
+  snapshot_id = table_info_snapshot;
+  return true;
+}
+
+void TableInfoCache::CopyTables(
+    const duckdb::set<idx_t> &except_ids,
+    duckdb::vector<duckdb::DuckLakeTableInfo> &tables) {
+  for (auto &entry : table_info_cache) {
+    if (!except_ids.count(entry.first)) {
+      tables.push_back(entry.second);
+    }
+  }
+}
+
+void TableInfoCache::Update(
+    idx_t snapshot_id, const duckdb::set<idx_t> *changed_ids,
+    const duckdb::vector<duckdb::DuckLakeTableInfo> &tables) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid)) {
+    return;
+  }
+  if (!changed_ids || relid != table_info_relid) {
+    table_info_cache.clear();
+    table_info_relid = relid;
+  } else {
+    // Changed tables that are not in `tables` were dropped
+    for (auto id : *changed_ids) {
+      table_info_cache.erase(id);
+    }
+  }
+  for (auto &table : tables) {
+    table_info_cache[table.id.index] = table;
+  }
+  table_info_snapshot = snapshot_id;
+  if (table_info_cache.size() > TABLE_INFO_CACHE_MAX_TABLES) {
+    table_info_cache.clear();
+  }
+}
+
+// Entries are dropped in LRU order beyond either limit. A file list costs a
+// few hundred bytes per file, so the default size holds the lists of a few
+// tables with a couple hundred thousand files each.
+constexpr size_t FILE_LIST_CACHE_MAX_ENTRIES = 64;
+static int file_list_cache_size = 256 * 1024;
+
+// Rereading the rows of more files than this share of a cached result costs
+// about as much as reading all of it
+constexpr idx_t FILE_LIST_REFRESH_MAX_SHARE = 2;
+
+struct FileListCacheEntry {
+  duckdb::string query;
+  idx_t table_id;
+  // The result is that of every snapshot in [min_snapshot, max_snapshot]
+  idx_t min_snapshot;
+  idx_t max_snapshot;
+  duckdb::vector<duckdb::string> names;
+  // The result column holding the data file id, if any
+  duckdb::optional_idx file_column;
+  // Never modified once cached, as results handed out still scan it
+  duckdb::shared_ptr<duckdb::ColumnDataCollection> collection;
+};
+
+// Most recently used first, all for the metadata of file_list_relid
+static Oid file_list_relid = InvalidOid;
+static std::list<FileListCacheEntry> file_list_cache;
+static idx_t file_list_cache_bytes = 0;
+
+/*
+ * FileListQueryResult - a read-only view of a cached file list. Chunks are
+ * scanned straight out of the cached collection, which the result keeps alive
+ * even if the entry is evicted or refreshed meanwhile.
+ */
+class FileListQueryResult : public duckdb::QueryResult {
+public:
+  FileListQueryResult(duckdb::vector<duckdb::string> names_p,
+                      duckdb::shared_ptr<duckdb::ColumnDataCollection> data)
+      : duckdb::QueryResult(duckdb::QueryResultType::STREAM_RESULT,
+                            duckdb::StatementType::SELECT_STATEMENT,
+                            duckdb::StatementProperties(), data->Types(),
+                            std::move(names_p), duckdb::ClientProperties()),
+        collection(std::move(data)) {
+    collection->InitializeScan(scan_state);
+  }
+
+  duckdb::string ToString() override {
+    return "[[cached file list of " + std::to_string(collection->Count()) +
+           " rows]]\n";
+  }
+
+  duckdb::unique_ptr<duckdb::DataChunk> FetchRaw() override {
+    auto chunk = duckdb::make_uniq<duckdb::DataChunk>();
+    collection->InitializeScanChunk(*chunk);
+    if (!collection->Scan(scan_state, *chunk)) {
+      return nullptr;
+    }
+    return chunk;
+  }
+
+private:
+  duckdb::shared_ptr<duckdb::ColumnDataCollection> collection;
+  duckdb::ColumnDataScanState scan_state;
+};
+
+static duckdb::unique_ptr<duckdb::QueryResult>
+ViewFileList(const FileListCacheEntry &entry) {
+  return duckdb::make_uniq<FileListQueryResult>(entry.names, entry.collection);
+}
+
+static std::list<FileListCacheEntry>::iterator
+FindFileList(const duckdb::string &query, idx_t table_id) {
+  for (auto it = file_list_cache.begin(); it != file_list_cache.end(); ++it) {
+    if (it->table_id == table_id && it->query == query) {
+      return it;
+    }
+  }
+  return file_list_cache.end();
+}
+
+static void EvictFileList(std::list<FileListCacheEntry>::iterator entry) {
+  file_list_cache_bytes -= entry->collection->SizeInBytes();
+  file_list_cache.erase(entry);
+}
+
+// Make room for `bytes` more, or return false if they do not fit at all
+static bool ReserveFileList(idx_t bytes) {
+  idx_t max_bytes = static_cast<idx_t>(file_list_cache_size) * 1024;
+  if (bytes > max_bytes) {
+    return false;
+  }
+  while (!file_list_cache.empty() &&
+         (file_list_cache.size() >= FILE_LIST_CACHE_MAX_ENTRIES ||
+          file_list_cache_bytes + bytes > max_bytes)) {
+    EvictFileList(std::prev(file_list_cache.end()));
+  }
+  return true;
+}
+
+static bool IsIdentChar(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// The identifier starting at `pos`
+static duckdb::string IdentAt(const duckdb::string &query, idx_t pos) {
+  idx_t end = pos;
+  while (end < query.size() && IsIdentChar(query[end])) {
+    end++;
+  }
+  return query.substr(pos, end - pos);
+}
+
+static idx_t SkipSpaces(const duckdb::string &query, idx_t pos) {
+  while (pos < query.size() &&
+         isspace(static_cast<unsigned char>(query[pos]))) {
+    pos++;
+  }
+  return pos;
+}
+
+// Positions of the whole identifiers in `query` that start with `prefix`
+static duckdb::vector<idx_t> FindIdents(const duckdb::string &query,
+                                        const char *prefix) {
+  duckdb::vector<idx_t> result;
+  for (auto pos = query.find(prefix); pos != duckdb::string::npos;
+       pos = query.find(prefix, pos + 1)) {
+    if (pos == 0 || !IsIdentChar(query[pos - 1])) {
+      result.push_back(pos);
+    }
+  }
+  return result;
+}
+
+bool FileListCache::IsActive() {
+  return file_list_cache_size > 0 && OidIsValid(CacheableSnapshotRelid());
+}
+
+bool FileListCache::IsCacheable(const duckdb::string &query, idx_t &table_id) {
+  if (file_list_cache_size == 0) {
+    return false;
+  }
+  // Only rows that never change once written, other than getting an end
+  // snapshot, and that are added and removed together with a file
+  bool reads_files = false;
+  for (auto pos : FindIdents(query, "ducklake_")) {
+    auto name = IdentAt(query, pos);
+    if (name == "ducklake_data_file" || name == "ducklake_delete_file") {
+      reads_files = true;
+    } else if (name != "ducklake_file_column_stats" &&
+               name != "ducklake_file_partition_value") {
+      return false;
+    }
+  }
+  if (!reads_files) {
+    return false;
+  }
+
+  // The snapshot id is the only placeholder the result may depend on
+  for (auto pos = query.find('{'); pos != duckdb::string::npos;
+       pos = query.find('{', pos + 1)) {
+    if (query.compare(pos, 13, "{SNAPSHOT_ID}") != 0) {
+      return false;
+    }
+  }
+
+  // ... and all of it must be about a single table
+  bool found = false;
+  for (auto pos : FindIdents(query, "table_id")) {
+    pos += strlen("table_id");
+    if (pos < query.size() && IsIdentChar(query[pos])) {
+      continue;
+    }
+    pos = SkipSpaces(query, pos);
+    if (pos >= query.size() || query[pos] != '=') {
+      continue;
+    }
+    pos = SkipSpaces(query, pos + 1);
+    idx_t digits = pos;
+    while (digits < query.size() &&
+           isdigit(static_cast<unsigned char>(query[digits]))) {
+      digits++;
+    }
+    if (digits == pos) {
+      continue;
+    }
+    idx_t id = std::stoull(query.substr(pos, digits - pos));
+    if (found && id != table_id) {
+      return false;
+    }
+    table_id = id;
+    found = true;
+  }
+  return found;
+}
+
+// The data_file_id column of a result, if it can be patched by file: rows
+// must not be ordered or limited across files.
+static duckdb::optional_idx
+FindFileColumn(const duckdb::string &query,
+               const duckdb::vector<duckdb::string> &names,
+               const duckdb::vector<duckdb::LogicalType> &types) {
+  if (!FindIdents(query, "ORDER").empty() ||
+      !FindIdents(query, "LIMIT").empty()) {
+    return duckdb::optional_idx();
+  }
+  for (idx_t i = 0; i < names.size(); i++) {
+    if (names[i] == "data_file_id" &&
+        types[i].id() == duckdb::LogicalTypeId::BIGINT) {
+      return i;
+    }
+  }
+  return duckdb::optional_idx();
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+FileListCache::Lookup(const duckdb::string &query, idx_t table_id,
+                      idx_t snapshot_id, duckdb::optional_idx &file_column,
+                      duckdb::set<idx_t> &changed_files) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid) || relid != file_list_relid ||
+      !CanReadMetadata({"ducklake_data_file", "ducklake_delete_file",
+                        "ducklake_file_column_stats",
+                        "ducklake_file_partition_value"})) {
+    return nullptr;
+  }
+  auto it = FindFileList(query, table_id);
+  if (it == file_list_cache.end()) {
+    return nullptr;
+  }
+  duckdb::set<idx_t> changed;
+  if (snapshot_id < it->min_snapshot) {
+    if (!ScanTableFilesChanged(table_id, snapshot_id, it->min_snapshot,
+                               changed) ||
+        !changed.empty()) {
+      return nullptr;
+    }
+    it->min_snapshot = snapshot_id;
+  } else if (snapshot_id > it->max_snapshot) {
+    if (!ScanTableFilesChanged(table_id, it->max_snapshot, snapshot_id,
+                               changed)) {
+      return nullptr;
+    }
+    if (!changed.empty()) {
+      if (it->file_column.IsValid() &&
+          changed.size() * FILE_LIST_REFRESH_MAX_SHARE <=
+              it->collection->Count()) {
+        file_column = it->file_column;
+        changed_files = std::move(changed);
+      }
+      return nullptr;
+    }
+    it->max_snapshot = snapshot_id;
+  }
+  file_list_cache.splice(file_list_cache.begin(), file_list_cache, it);
+  return ViewFileList(*it);
+}
+
+// `cached` without the rows of `changed_files`, followed by `rows`
+static duckdb::shared_ptr<duckdb::ColumnDataCollection>
+MergeFileList(const duckdb::ColumnDataCollection &cached, idx_t file_column,
+              const duckdb::set<idx_t> &changed_files,
+              const duckdb::ColumnDataCollection &rows) {
+  auto &allocator = duckdb::Allocator::DefaultAllocator();
+  auto merged = duckdb::make_shared_ptr<duckdb::ColumnDataCollection>(
+      allocator, cached.Types());
+  duckdb::DataChunk kept;
+  kept.Initialize(allocator, cached.Types());
+  for (auto &chunk : cached.Chunks()) {
+    duckdb::UnifiedVectorFormat ids;
+    chunk.data[file_column].ToUnifiedFormat(chunk.size(), ids);
+    auto id_data = duckdb::UnifiedVectorFormat::GetData<int64_t>(ids);
+    duckdb::SelectionVector sel(chunk.size());
+    idx_t count = 0;
+    for (idx_t row = 0; row < chunk.size(); row++) {
+      auto idx = ids.sel->get_index(row);
+      if (!ids.validity.RowIsValid(idx) ||
+          changed_files.find(id_data[idx]) == changed_files.end()) {
+        sel.set_index(count++, row);
+      }
+    }
+    if (count == chunk.size()) {
+      merged->Append(chunk);
+    } else if (count > 0) {
+      kept.Reset();
+      chunk.Copy(kept, sel, count);
+      merged->Append(kept);
+    }
+  }
+  for (auto &chunk : rows.Chunks()) {
+    merged->Append(chunk);
+  }
+  return merged;
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+FileListCache::Refresh(const duckdb::string &query, idx_t table_id,
+                       idx_t snapshot_id,
+                       const duckdb::set<idx_t> &changed_files,
+                       duckdb::unique_ptr<duckdb::QueryResult> rows) {
+  auto it = FindFileList(query, table_id);
+  if (it == file_list_cache.end() || !it->file_column.IsValid() ||
+      snapshot_id <= it->max_snapshot || !rows || rows->HasError() ||
+      rows->type != duckdb::QueryResultType::MATERIALIZED_RESULT ||
+      rows->types != it->collection->Types()) {
+    return nullptr;
+  }
+  auto &materialized = rows->Cast<duckdb::MaterializedQueryResult>();
+  auto merged = MergeFileList(*it->collection, it->file_column.GetIndex(),
+                              changed_files, materialized.Collection());
+
+  // The entry is replaced rather than modified: earlier hits may still be
+  // scanning the old rows
+  auto entry = FileListCacheEntry{query,       table_id,
+                                  snapshot_id, snapshot_id,
+                                  it->names,   it->file_column,
+                                  std::move(merged)};
+  EvictFileList(it);
+  idx_t bytes = entry.collection->SizeInBytes();
+  auto result = ViewFileList(entry);
+  if (ReserveFileList(bytes)) {
+    file_list_cache.push_front(std::move(entry));
+    file_list_cache_bytes += bytes;
+  }
+  return result;
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+FileListCache::Store(const duckdb::string &query, idx_t table_id,
+                     idx_t snapshot_id,
+                     duckdb::unique_ptr<duckdb::QueryResult> result) {
+  Oid relid = CacheableSnapshotRelid();
+  if (!OidIsValid(relid) || !result || result->HasError() ||
+      result->type != duckdb::QueryResultType::MATERIALIZED_RESULT) {
+    return result;
+  }
+  if (relid != file_list_relid) {
+    file_list_cache.clear();
+    file_list_cache_bytes = 0;
+    file_list_relid = relid;
+  }
+  auto it = FindFileList(query, table_id);
+  if (it != file_list_cache.end()) {
+    EvictFileList(it);
+  }
+
+  auto &materialized = result->Cast<duckdb::MaterializedQueryResult>();
+  idx_t bytes = materialized.Collection().SizeInBytes();
+  if (!ReserveFileList(bytes)) {
+    return result;
+  }
+  auto file_column = FindFileColumn(query, result->names, result->types);
+  file_list_cache.push_front(FileListCacheEntry{
+      query, table_id, snapshot_id, snapshot_id, result->names, file_column,
+      duckdb::shared_ptr<duckdb::ColumnDataCollection>(
+          materialized.TakeCollection())});
+  file_list_cache_bytes += bytes;
+  return ViewFileList(file_list_cache.front());
+}
+
+duckdb::vector<duckdb::string> FileListCache::GetQueries() {
+  duckdb::vector<duckdb::string> queries;
+  for (auto &entry : file_list_cache) {
+    queries.push_back(entry.query);
+  }
+  return queries;
+}
+
+} // namespace pgducklake
+
+extern "C" {
+
+void ducklake_init_file_list_cache(void) {
+  DefineCustomIntVariable(
+      "ducklake.file_list_cache_size",
+      "Size of the cache of DuckLake file lists of each backend.",
+      "0 disables the cache.", &pgducklake::file_list_cache_size, 256 * 1024,
+      0, INT_MAX / 1024, PGC_USERSET, GUC_UNIT_KB, NULL, NULL, NULL);
+}
+
+} // extern "C"
@@ -1,9 +1,13 @@
 #include "pgducklake/pgducklake_defs.hpp"
 #include "pgducklake/pgducklake_metadata_manager.hpp"
+#include "pgducklake/pgducklake_pg_types.hpp"
 #include "pgducklake/utility/cpp_wrapper.hpp"
 
 #include <duckdb/common/string_util.hpp>
 #include <duckdb/parser/keyword_helper.hpp>
+#include <duckdb/parser/parsed_data/create_table_info.hpp>
+#include <duckdb/parser/parser.hpp>
+#include <duckdb/parser/statement/create_statement.hpp>
 #include <filesystem>
 
 extern "C" {
@@ -95,6 +99,151 @@ int ExecuteDuckDBQuery(const char *query, const char **errmsg_out) {
   return result;
 }
 
+/*
+ * Indexes on the metadata tables that DuckLake creates at ATTACH time, for
+ * the access paths of PgDuckLakeMetadataManager on the tables that grow with
+ * every table change and every insert: lookups by table (or object) id as of
+ * a snapshot, the current version of an object, i.e. the row whose
+ * end_snapshot is still NULL, and the rows changed between two snapshots.
+ * Schemas, views and partitions only change with their own DDL and are read
+ * in full.
+ */
+static const char *const METADATA_INDEXES[] = {
+    // objects by id at older snapshots, and their current version
+    "ducklake_table_table_id_idx ON ducklake.ducklake_table "
+    "(table_id, begin_snapshot)",
+    "ducklake_table_current_idx ON ducklake.ducklake_table (table_id) "
+    "WHERE end_snapshot IS NULL",
+    "ducklake_column_table_id_idx ON ducklake.ducklake_column "
+    "(table_id, begin_snapshot)",
+    "ducklake_column_current_idx ON ducklake.ducklake_column (table_id) "
+    "WHERE end_snapshot IS NULL",
+    "ducklake_tag_object_id_idx ON ducklake.ducklake_tag "
+    "(object_id, begin_snapshot)",
+    "ducklake_tag_current_idx ON ducklake.ducklake_tag (object_id) "
+    "WHERE end_snapshot IS NULL",
+    "ducklake_column_tag_table_id_idx ON ducklake.ducklake_column_tag "
+    "(table_id, column_id, begin_snapshot)",
+    "ducklake_column_tag_current_idx ON ducklake.ducklake_column_tag "
+    "(table_id, column_id) WHERE end_snapshot IS NULL",
+    "ducklake_inlined_data_tables_table_id_idx ON "
+    "ducklake.ducklake_inlined_data_tables (table_id)",
+    // rows created or ended between two snapshots, for catalog refreshes, and
+    // rows still live at an older snapshot, for its catalog
+    "ducklake_table_begin_idx ON ducklake.ducklake_table (begin_snapshot)",
+    "ducklake_table_end_idx ON ducklake.ducklake_table (end_snapshot)",
+    "ducklake_column_begin_idx ON ducklake.ducklake_column (begin_snapshot)",
+    "ducklake_column_end_idx ON ducklake.ducklake_column (end_snapshot)",
+    "ducklake_column_tag_begin_idx ON ducklake.ducklake_column_tag "
+    "(begin_snapshot)",
+    "ducklake_column_tag_end_idx ON ducklake.ducklake_column_tag "
+    "(end_snapshot)",
+    "ducklake_tag_begin_idx ON ducklake.ducklake_tag (begin_snapshot)",
+    "ducklake_tag_end_idx ON ducklake.ducklake_tag (end_snapshot)",
+    // files of a table added since a snapshot, or visible at an older one;
+    // and those removed since a snapshot, or, with a NULL end_snapshot, the
+    // current ones
+    "ducklake_data_file_table_id_idx ON ducklake.ducklake_data_file "
+    "(table_id, begin_snapshot)",
+    "ducklake_data_file_table_id_end_idx ON ducklake.ducklake_data_file "
+    "(table_id, end_snapshot)",
+    "ducklake_delete_file_table_id_idx ON ducklake.ducklake_delete_file "
+    "(table_id, begin_snapshot)",
+    "ducklake_delete_file_table_id_end_idx ON ducklake.ducklake_delete_file "
+    "(table_id, end_snapshot)",
+};
+
+static void CreateMetadataIndexes() {
+  SPI_connect();
+  for (auto index : METADATA_INDEXES) {
+    std::string query = std::string("CREATE INDEX IF NOT EXISTS ") + index;
+    int ret = SPI_exec(query.c_str(), 0);
+    if (ret != SPI_OK_UTILITY) {
+      elog(ERROR, "SPI_exec failed: error code %s",
+           SPI_result_code_string(ret));
+    }
+  }
+  SPI_finish();
+}
+
+// Every writer of ducklake_snapshot, including DuckDB clients attached to the
+// metadata directly, goes through this trigger, which tracks the latest
+// snapshot in shared memory
+static void CreateSnapshotTrigger() {
+  SPI_connect();
+  int ret = SPI_exec(
+      "CREATE TRIGGER ducklake_snapshot_written "
+      "AFTER INSERT ON ducklake.ducklake_snapshot "
+      "FOR EACH ROW EXECUTE FUNCTION ducklake._snapshot_written()",
+      0);
+  if (ret != SPI_OK_UTILITY) {
+    elog(ERROR, "SPI_exec failed: error code %s", SPI_result_code_string(ret));
+  }
+  SPI_finish();
+}
+
+/*
+ * pgduckdb_get_tabledef() spells column types as PostgreSQL does, which DuckDB
+ * cannot resolve for user-defined composite and enum types. Give those
+ * columns (and arrays of them) the DuckDB type instead: composites become
+ * STRUCT, with every field converted, and enums VARCHAR, since DuckLake cannot
+ * store ENUM columns. Labels added to an enum later thus need no change to
+ * the table. The statement is parsed and its columns retyped by name, then
+ * printed again.
+ */
+static std::string RewriteUserDefinedColumnTypes(Oid relid,
+                                                 const std::string &ddl) {
+  duckdb::vector<std::pair<std::string, duckdb::LogicalType>> columns;
+  Relation rel = relation_open(relid, AccessShareLock);
+  TupleDesc tupdesc = RelationGetDescr(rel);
+  for (int i = 0; i < tupdesc->natts; i++) {
+    Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+    if (attr->attisdropped) {
+      continue;
+    }
+    Oid base_type = get_element_type(attr->atttypid);
+    if (!OidIsValid(base_type)) {
+      base_type = attr->atttypid;
+    }
+    if (!type_is_rowtype(base_type) && !type_is_enum(base_type)) {
+      continue;
+    }
+    auto duck_type = pgducklake::ConvertPostgresToDuckLakeType(
+        attr->atttypid, attr->atttypmod);
+    if (duck_type.id() == duckdb::LogicalTypeId::SQLNULL) {
+      ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                      errmsg("column \"%s\" has a type DuckLake does not "
+                             "support: %s",
+                             NameStr(attr->attname),
+                             format_type_be(attr->atttypid))));
+    }
+    columns.emplace_back(NameStr(attr->attname), std::move(duck_type));
+  }
+  relation_close(rel, AccessShareLock);
+  if (columns.empty()) {
+    return ddl;
+  }
+
+  duckdb::Parser parser;
+  parser.ParseQuery(ddl);
+  if (parser.statements.size() != 1 ||
+      parser.statements[0]->type != duckdb::StatementType::CREATE_STATEMENT) {
+    elog(ERROR, "unexpected DuckLake table definition: %s", ddl.c_str());
+  }
+  auto &create = parser.statements[0]->Cast<duckdb::CreateStatement>();
+  if (create.info->type != duckdb::CatalogType::TABLE_ENTRY) {
+    elog(ERROR, "unexpected DuckLake table definition: %s", ddl.c_str());
+  }
+  auto &info = create.info->Cast<duckdb::CreateTableInfo>();
+  for (auto &column : columns) {
+    if (!info.columns.ColumnExists(column.first)) {
+      elog(ERROR, "column \"%s\" is missing from DuckLake table definition: %s",
+           column.first.c_str(), ddl.c_str());
+    }
+    info.columns.GetColumnMutable(column.first).SetType(column.second);
+  }
+  return info.ToString();
+}
 
 extern "C" {
 
@@ -115,6 +264,9 @@ DECLARE_PG_FUNCTION(ducklake_initialize) {
   }
   // force creating DuckDB instance
   ExecuteDuckDBQuery("SELECT 1", NULL);
+  // the instance attached DuckLake, which created the metadata tables
+  CreateMetadataIndexes();
+  CreateSnapshotTrigger();
   
   // Recycle DuckDB instance
 
@@ -195,7 +347,8 @@ DECLARE_PG_FUNCTION(ducklake_create_table_trigger) {
   SPI_finish();
 
   // Generate CREATE TABLE DDL for DuckDB
-  std::string create_table_ddl(pgduckdb_get_tabledef(relid));
+  std::string create_table_ddl = RewriteUserDefinedColumnTypes(
+      relid, pgduckdb_get_tabledef(relid));
   elog(DEBUG1, "Creating DuckLake table: %s", create_table_ddl.c_str());
 
   // Execute CREATE TABLE in DuckDB via raw_query
@@ -0,0 +1,403 @@
+#include "pgducklake/pgducklake_metadata_batch.hpp"
+
+#include "pgducklake/pgducklake_metadata_insert.hpp"
+#include "pgducklake/pgducklake_spi.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "executor/spi.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "parser/parser.h"
+#include "utils/builtins.h"
+#include "utils/tuplestore.h"
+}
+
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include <duckdb/common/string_util.hpp>
+
+#include <cctype>
+#include <cstring>
+
+namespace pgducklake {
+
+static bool IsSpace(char c) { return isspace(static_cast<unsigned char>(c)); }
+
+// Whether `c` may continue an identifier; '$' may, so "a$1" is one word.
+static bool IsIdentChar(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+
+// Returns the position past the quoted literal or identifier starting at
+// `pos`, or sql.size() if it is unterminated. A doubled quote character is an
+// escaped quote; with `backslash_escapes`, so is a backslash before any
+// character.
+static idx_t SkipQuoted(const duckdb::string &sql, idx_t pos,
+                        bool backslash_escapes = false) {
+  char quote = sql[pos++];
+  while (pos < sql.size()) {
+    if (backslash_escapes && sql[pos] == '\\') {
+      pos += 2;
+      continue;
+    }
+    if (sql[pos] == quote) {
+      if (pos + 1 < sql.size() && sql[pos + 1] == quote) {
+        pos += 2;
+        continue;
+      }
+      return pos + 1;
+    }
+    pos++;
+  }
+  return sql.size();
+}
+
+// Returns the position past the "$tag$...$tag$" string starting at `pos`, or
+// `pos` itself if there is none there, e.g. for a "$1" parameter.
+static idx_t SkipDollarQuoted(const duckdb::string &sql, idx_t pos) {
+  idx_t tag_end = pos + 1;
+  if (tag_end < sql.size() &&
+      isdigit(static_cast<unsigned char>(sql[tag_end]))) {
+    return pos;
+  }
+  while (tag_end < sql.size() && sql[tag_end] != '$' &&
+         IsIdentChar(sql[tag_end])) {
+    tag_end++;
+  }
+  if (tag_end == sql.size() || sql[tag_end] != '$') {
+    return pos;
+  }
+  auto tag = sql.substr(pos, tag_end + 1 - pos);
+  auto end = sql.find(tag, tag_end + 1);
+  return end == duckdb::string::npos ? sql.size() : end + tag.size();
+}
+
+/*
+ * If a literal, quoted identifier or comment starts at `pos`, returns the
+ * position past it (sql.size() if it is unterminated), otherwise `pos`. Knows
+ * about standard and E'' strings, dollar quoting, "--" comments and nested
+ * C-style comments.
+ */
+static idx_t SkipLiteralOrComment(const duckdb::string &sql, idx_t pos) {
+  char c = sql[pos];
+  char next = pos + 1 < sql.size() ? sql[pos + 1] : '\0';
+  bool word_start = pos == 0 || !IsIdentChar(sql[pos - 1]);
+  switch (c) {
+  case '"':
+    return SkipQuoted(sql, pos);
+  case '\'': {
+    // An E prefix, not the end of some longer word
+    bool escape_string = pos > 0 &&
+                         (sql[pos - 1] == 'E' || sql[pos - 1] == 'e') &&
+                         (pos == 1 || !IsIdentChar(sql[pos - 2]));
+    return SkipQuoted(sql, pos, escape_string || !standard_conforming_strings);
+  }
+  case '$':
+    return word_start ? SkipDollarQuoted(sql, pos) : pos;
+  case '-':
+    if (next == '-') {
+      auto end = sql.find('\n', pos);
+      return end == duckdb::string::npos ? sql.size() : end + 1;
+    }
+    return pos;
+  case '/':
+    if (next == '*') {
+      int depth = 0;
+      while (pos + 1 < sql.size()) {
+        if (sql[pos] == '/' && sql[pos + 1] == '*') {
+          depth++;
+          pos += 2;
+        } else if (sql[pos] == '*' && sql[pos + 1] == '/') {
+          pos += 2;
+          if (--depth == 0) {
+            return pos;
+          }
+        } else {
+          pos++;
+        }
+      }
+      return sql.size();
+    }
+    return pos;
+  default:
+    return pos;
+  }
+}
+
+// Skip whitespace and comments
+static idx_t SkipSpaces(const duckdb::string &sql, idx_t pos) {
+  while (pos < sql.size()) {
+    if (IsSpace(sql[pos])) {
+      pos++;
+      continue;
+    }
+    char c = sql[pos];
+    idx_t end = c == '-' || c == '/' ? SkipLiteralOrComment(sql, pos) : pos;
+    if (end == pos) {
+      break;
+    }
+    pos = end;
+  }
+  return pos;
+}
+
+// Match the keyword `kw` at `pos`, case-insensitively and as a whole word.
+static bool MatchKeyword(const duckdb::string &sql, idx_t pos, const char *kw) {
+  size_t len = strlen(kw);
+  if (pos + len > sql.size() || pg_strncasecmp(sql.c_str() + pos, kw, len)) {
+    return false;
+  }
+  if (pos + len == sql.size()) {
+    return true;
+  }
+  char next = sql[pos + len];
+  return !isalnum(static_cast<unsigned char>(next)) && next != '_';
+}
+
+// Split on top-level ';', i.e. outside literals and comments.
+static void SplitStatements(const duckdb::string &batch,
+                            duckdb::vector<duckdb::string> &statements) {
+  idx_t start = 0;
+  for (idx_t pos = 0; pos < batch.size();) {
+    idx_t end = SkipLiteralOrComment(batch, pos);
+    if (end != pos) {
+      pos = end;
+      continue;
+    }
+    if (batch[pos] == ';') {
+      statements.push_back(batch.substr(start, pos - start));
+      start = pos + 1;
+    }
+    pos++;
+  }
+  statements.push_back(batch.substr(start));
+}
+
+// Parse "INSERT INTO <target> [(<columns>)] VALUES (...)[, (...)]*". Anything
+// else, including ON CONFLICT or RETURNING clauses, is not coalescable.
+static bool ParseInsert(const duckdb::string &sql, MetadataStatement &stmt) {
+  idx_t pos = SkipSpaces(sql, 0);
+  if (!MatchKeyword(sql, pos, "INSERT")) {
+    return false;
+  }
+  pos = SkipSpaces(sql, pos + 6);
+  if (!MatchKeyword(sql, pos, "INTO")) {
+    return false;
+  }
+  pos = SkipSpaces(sql, pos + 4);
+
+  // Possibly quoted, possibly qualified table name
+  idx_t target_start = pos;
+  while (pos < sql.size() && !IsSpace(sql[pos]) && sql[pos] != '(') {
+    idx_t end = SkipLiteralOrComment(sql, pos);
+    if (end != pos && sql[pos] != '"') {
+      // A comment ends the name
+      break;
+    }
+    pos = end == pos ? pos + 1 : end;
+  }
+  if (pos == target_start) {
+    return false;
+  }
+  stmt.target = sql.substr(target_start, pos - target_start);
+  pos = SkipSpaces(sql, pos);
+
+  if (pos < sql.size() && sql[pos] == '(') {
+    idx_t columns_start = pos;
+    while (pos < sql.size() && sql[pos] != ')') {
+      idx_t end = SkipLiteralOrComment(sql, pos);
+      pos = end == pos ? pos + 1 : end;
+    }
+    if (pos == sql.size()) {
+      return false;
+    }
+    pos++;
+    stmt.columns = sql.substr(columns_start, pos - columns_start);
+    pos = SkipSpaces(sql, pos);
+  }
+
+  if (!MatchKeyword(sql, pos, "VALUES")) {
+    return false;
+  }
+  pos += 6;
+
+  // Only parenthesized rows separated by commas may follow
+  while (true) {
+    pos = SkipSpaces(sql, pos);
+    if (pos == sql.size() || sql[pos] != '(') {
+      return false;
+    }
+    idx_t row_start = pos;
+    int depth = 0;
+    while (pos < sql.size()) {
+      idx_t end = SkipLiteralOrComment(sql, pos);
+      if (end != pos) {
+        pos = end;
+        continue;
+      }
+      char c = sql[pos++];
+      if (c == '(') {
+        depth++;
+      } else if (c == ')' && --depth == 0) {
+        break;
+      }
+    }
+    if (depth != 0) {
+      return false;
+    }
+    stmt.rows.push_back(sql.substr(row_start, pos - row_start));
+
+    pos = SkipSpaces(sql, pos);
+    if (pos == sql.size()) {
+      break;
+    }
+    if (sql[pos] != ',') {
+      return false;
+    }
+    pos++;
+  }
+
+  stmt.is_insert = true;
+  stmt.text = "INSERT INTO " + stmt.target +
+              (stmt.columns.empty() ? "" : " " + stmt.columns) + " VALUES ";
+  return true;
+}
+
+duckdb::string MetadataStatement::ToSQL() const {
+  if (!is_insert) {
+    return text;
+  }
+  duckdb::string sql = text;
+  for (idx_t i = 0; i < rows.size(); i++) {
+    if (i > 0) {
+      sql += ", ";
+    }
+    sql += rows[i];
+  }
+  return sql;
+}
+
+duckdb::vector<MetadataStatement>
+CoalesceMetadataBatch(const duckdb::string &batch) {
+  duckdb::vector<MetadataStatement> result;
+  duckdb::vector<duckdb::string> statements;
+  SplitStatements(batch, statements);
+
+  for (auto &sql : statements) {
+    if (SkipSpaces(sql, 0) == sql.size()) {
+      continue;
+    }
+
+    MetadataStatement stmt;
+    if (!ParseInsert(sql, stmt)) {
+      stmt = MetadataStatement();
+      stmt.text = std::move(sql);
+      result.push_back(std::move(stmt));
+      continue;
+    }
+
+    // Only merge into the statement right before, so that nothing is
+    // reordered
+    if (!result.empty() && result.back().is_insert &&
+        result.back().target == stmt.target &&
+        result.back().columns == stmt.columns) {
+      auto &rows = result.back().rows;
+      rows.insert(rows.end(), std::make_move_iterator(stmt.rows.begin()),
+                  std::make_move_iterator(stmt.rows.end()));
+      continue;
+    }
+    result.push_back(std::move(stmt));
+  }
+  return result;
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteMetadataBatch(const duckdb::vector<MetadataStatement> &statements) {
+  duckdb::unique_ptr<duckdb::QueryResult> result;
+  duckdb::string pending;
+  for (auto &stmt : statements) {
+    auto direct_insert = DirectMetadataInsert::Prepare(stmt);
+    if (!direct_insert) {
+      pending += stmt.ToSQL();
+      pending += ";\n";
+      continue;
+    }
+    // Statements before the insert must run first
+    if (!pending.empty()) {
+      result = ExecuteSPIQuery(pending);
+      if (result->HasError()) {
+        return result;
+      }
+      pending.clear();
+    }
+    direct_insert->Execute();
+    result = EmptySPIResult(SPI_OK_INSERT);
+  }
+  if (!pending.empty() || !result) {
+    result = ExecuteSPIQuery(pending);
+  }
+  return result;
+}
+
+} // namespace pgducklake
+
+extern "C" {
+
+/*
+ * ducklake_explain_metadata_batch(batch) - The statements a batch of metadata
+ * writes is run as, and whether each is appended directly, for tests. Nothing
+ * is executed.
+ */
+DECLARE_PG_FUNCTION(ducklake_explain_metadata_batch) {
+  auto *rsinfo = reinterpret_cast<ReturnSetInfo *>(fcinfo->resultinfo);
+  if (!rsinfo || !IsA(rsinfo, ReturnSetInfo) ||
+      !(rsinfo->allowedModes & SFRM_Materialize)) {
+    elog(ERROR, "materialize mode required, but it is not allowed in this "
+                "context");
+  }
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+
+  MemoryContext old_context =
+      MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+  Tuplestorestate *tupstore = tuplestore_begin_heap(true, false, work_mem);
+  rsinfo->returnMode = SFRM_Materialize;
+  rsinfo->setResult = tupstore;
+  rsinfo->setDesc = CreateTupleDescCopy(tupdesc);
+  MemoryContextSwitchTo(old_context);
+
+  duckdb::string batch = text_to_cstring(PG_GETARG_TEXT_PP(0));
+  for (auto &stmt : pgducklake::CoalesceMetadataBatch(batch)) {
+    auto sql = stmt.ToSQL();
+    duckdb::StringUtil::Trim(sql);
+    Datum values[2];
+    bool nulls[2] = {false, false};
+    values[0] = CStringGetTextDatum(sql.c_str());
+    values[1] = BoolGetDatum(pgducklake::DirectMetadataInsert::Prepare(stmt) !=
+                             nullptr);
+    tuplestore_putvalues(tupstore, rsinfo->setDesc, values, nulls);
+  }
+  return (Datum)0;
+}
+
+/*
+ * ducklake_execute_metadata_batch(batch) - Run a batch of metadata writes as
+ * the metadata manager runs a commit, for tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_execute_metadata_batch) {
+  duckdb::string batch = text_to_cstring(PG_GETARG_TEXT_PP(0));
+  auto result = pgducklake::ExecuteMetadataBatch(
+      pgducklake::CoalesceMetadataBatch(batch));
+  if (result->HasError()) {
+    elog(ERROR, "%s", result->GetError().c_str());
+  }
+  PG_RETURN_VOID();
+}
+
+} // extern "C"
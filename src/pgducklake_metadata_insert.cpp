@@ -0,0 +1,429 @@
+#include "pgducklake/pgducklake_metadata_insert.hpp"
+
+// DuckDB headers first
+#include "duckdb/common/helper.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_index.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "parser/parser.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+#include "utils/syscache.h"
+#include "utils/varlena.h"
+}
+
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include "pgducklake/utility/unsafe_command_id_guard.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace pgducklake {
+
+// Rows handed to table_multi_insert at once, as in COPY FROM
+constexpr idx_t MULTI_INSERT_BATCH_SIZE = 1000;
+
+static idx_t SkipSpaces(const duckdb::string &sql, idx_t pos) {
+  while (pos < sql.size() && isspace(static_cast<unsigned char>(sql[pos]))) {
+    pos++;
+  }
+  return pos;
+}
+
+/*
+ * Parse a "(v1, v2, ...)" row whose values are all plain literals: NULL,
+ * TRUE/FALSE, numbers or standard single-quoted strings. Returns false for
+ * anything else (casts, function calls, DEFAULT, ...), which needs the
+ * executor.
+ */
+using LiteralKind = DirectMetadataInsert::LiteralKind;
+
+static bool
+ParseLiteralRow(const duckdb::string &row,
+                duckdb::vector<DirectMetadataInsert::LiteralValue> &values) {
+  idx_t pos = SkipSpaces(row, 0);
+  if (pos == row.size() || row[pos] != '(') {
+    return false;
+  }
+  pos++;
+
+  while (true) {
+    pos = SkipSpaces(row, pos);
+    if (pos == row.size()) {
+      return false;
+    }
+
+    DirectMetadataInsert::LiteralValue value;
+    if (row[pos] == '\'') {
+      value.kind = LiteralKind::STRING;
+      pos++;
+      while (true) {
+        if (pos == row.size()) {
+          return false;
+        }
+        if (row[pos] == '\'') {
+          if (pos + 1 < row.size() && row[pos + 1] == '\'') {
+            value.text += '\'';
+            pos += 2;
+            continue;
+          }
+          pos++;
+          break;
+        }
+        // Without standard_conforming_strings, backslashes are escapes
+        if (row[pos] == '\\' && !standard_conforming_strings) {
+          return false;
+        }
+        value.text += row[pos++];
+      }
+    } else {
+      idx_t start = pos;
+      while (pos < row.size() &&
+             (isalnum(static_cast<unsigned char>(row[pos])) ||
+              strchr(".-+_", row[pos]) != nullptr)) {
+        pos++;
+      }
+      value.text = row.substr(start, pos - start);
+      if (value.text.empty()) {
+        return false;
+      }
+      if (pg_strcasecmp(value.text.c_str(), "NULL") == 0) {
+        value.kind = LiteralKind::NULL_VALUE;
+      } else if (pg_strcasecmp(value.text.c_str(), "TRUE") == 0 ||
+                 pg_strcasecmp(value.text.c_str(), "FALSE") == 0) {
+        value.kind = LiteralKind::BOOL;
+      } else {
+        // A number: an optional sign, then digits, '.' and an exponent
+        idx_t i = value.text[0] == '-' || value.text[0] == '+' ? 1 : 0;
+        if (i == value.text.size() ||
+            !(isdigit(static_cast<unsigned char>(value.text[i])) ||
+              value.text[i] == '.')) {
+          return false;
+        }
+        value.kind = LiteralKind::INTEGER;
+        for (; i < value.text.size(); i++) {
+          char c = value.text[i];
+          bool exponent_sign = (c == '-' || c == '+') &&
+                               (value.text[i - 1] == 'e' ||
+                                value.text[i - 1] == 'E');
+          if (!isdigit(static_cast<unsigned char>(c)) && c != '.' &&
+              c != 'e' && c != 'E' && !exponent_sign) {
+            return false;
+          }
+          if (!isdigit(static_cast<unsigned char>(c))) {
+            value.kind = LiteralKind::DECIMAL;
+          }
+        }
+      }
+    }
+    values.push_back(std::move(value));
+
+    pos = SkipSpaces(row, pos);
+    if (pos == row.size()) {
+      return false;
+    }
+    if (row[pos] == ')') {
+      break;
+    }
+    if (row[pos] != ',') {
+      return false;
+    }
+    pos++;
+  }
+  return SkipSpaces(row, pos + 1) == row.size();
+}
+
+// Map the statement's column list (or the table's own column order) to
+// attribute numbers. Every column must be listed exactly once, so that no
+// default expression has to be evaluated.
+static bool ResolveTargetColumns(Relation rel, const duckdb::string &columns,
+                                 duckdb::vector<AttrNumber> &attnums) {
+  TupleDesc tupdesc = RelationGetDescr(rel);
+  int live_columns = 0;
+  for (int i = 0; i < tupdesc->natts; i++) {
+    if (!TupleDescAttr(tupdesc, i)->attisdropped) {
+      live_columns++;
+    }
+  }
+
+  if (columns.empty()) {
+    for (int i = 0; i < tupdesc->natts; i++) {
+      if (!TupleDescAttr(tupdesc, i)->attisdropped) {
+        attnums.push_back(static_cast<AttrNumber>(i + 1));
+      }
+    }
+    return true;
+  }
+
+  // Strip the parentheses
+  char *list = pstrdup(columns.substr(1, columns.size() - 2).c_str());
+  List *names = NIL;
+  if (!SplitIdentifierString(list, ',', &names)) {
+    return false;
+  }
+
+  duckdb::vector<bool> seen(tupdesc->natts, false);
+  ListCell *lc;
+  foreach (lc, names) {
+    AttrNumber attnum = get_attnum(RelationGetRelid(rel),
+                                   static_cast<char *>(lfirst(lc)));
+    if (attnum <= 0 || seen[attnum - 1]) {
+      return false;
+    }
+    seen[attnum - 1] = true;
+    attnums.push_back(attnum);
+  }
+  return static_cast<int>(attnums.size()) == live_columns;
+}
+
+static Oid ResolveTarget(const duckdb::string &target) {
+#if PG_VERSION_NUM >= 160000
+  List *names = stringToQualifiedNameList(target.c_str(), nullptr);
+#else
+  List *names = stringToQualifiedNameList(target.c_str());
+#endif
+  RangeVar *rv = makeRangeVarFromNameList(names);
+  return RangeVarGetRelid(rv, RowExclusiveLock, true);
+}
+
+// Whether the indexes of `rel` are all checked right away by
+// ExecInsertIndexTuples: deferred unique checks and exclusion constraints
+// need the executor's recheck.
+static bool HasOnlyImmediateIndexes(Relation rel) {
+  List *indexes = RelationGetIndexList(rel);
+  bool immediate = true;
+  ListCell *lc;
+  foreach (lc, indexes) {
+    HeapTuple tuple =
+        SearchSysCache1(INDEXRELID, ObjectIdGetDatum(lfirst_oid(lc)));
+    if (!HeapTupleIsValid(tuple)) {
+      elog(ERROR, "cache lookup failed for index %u", lfirst_oid(lc));
+    }
+    auto *index = reinterpret_cast<Form_pg_index>(GETSTRUCT(tuple));
+    immediate = immediate && index->indimmediate && !index->indisexclusion;
+    ReleaseSysCache(tuple);
+  }
+  list_free(indexes);
+  return immediate;
+}
+
+// Whether rows can be put into `rel` without running the executor: a plain
+// DuckLake metadata table without triggers, rules, row security, CHECK
+// constraints, generated columns or deferred index checks, which the current
+// user may insert into.
+static bool SupportsDirectInsert(Relation rel) {
+  if (rel->rd_rel->relkind != RELKIND_RELATION ||
+      strncmp(RelationGetRelationName(rel), "ducklake_", 9) != 0) {
+    return false;
+  }
+  if (rel->trigdesc || rel->rd_rel->relhasrules ||
+      rel->rd_rel->relrowsecurity) {
+    return false;
+  }
+  TupleConstr *constr = RelationGetDescr(rel)->constr;
+  if (constr && (constr->num_check > 0 || constr->has_generated_stored)) {
+    return false;
+  }
+  if (!HasOnlyImmediateIndexes(rel)) {
+    return false;
+  }
+  return pg_class_aclcheck(RelationGetRelid(rel), GetUserId(), ACL_INSERT) ==
+         ACLCHECK_OK;
+}
+
+/*
+ * Whether the input function of a column of type `typid` reads `value` as the
+ * executor would convert the literal. Quoted strings are of unknown type and
+ * always go through the input function. Numbers are integer or numeric
+ * constants and assignment-cast: into text that would turn "+1" into "1", and
+ * into an integer column "1.5" is rounded, not rejected.
+ */
+static bool LiteralFitsColumn(const DirectMetadataInsert::LiteralValue &value,
+                              Oid typid) {
+  bool is_decimal_type =
+      typid == NUMERICOID || typid == FLOAT4OID || typid == FLOAT8OID;
+  switch (value.kind) {
+  case LiteralKind::NULL_VALUE:
+  case LiteralKind::STRING:
+    return true;
+  case LiteralKind::BOOL:
+    return typid == BOOLOID;
+  case LiteralKind::INTEGER:
+    return typid == INT2OID || typid == INT4OID || typid == INT8OID ||
+           is_decimal_type;
+  case LiteralKind::DECIMAL:
+    return is_decimal_type;
+  }
+  return false;
+}
+
+static void InsertSlots(ResultRelInfo *result_rel_info, EState *estate,
+                        TupleTableSlot **slots, int num_slots) {
+  Relation rel = result_rel_info->ri_RelationDesc;
+  table_multi_insert(rel, slots, num_slots, GetCurrentCommandId(true), 0,
+                     nullptr);
+
+  if (result_rel_info->ri_NumIndices == 0) {
+    return;
+  }
+  for (int i = 0; i < num_slots; i++) {
+    List *recheck = ExecInsertIndexTuples(result_rel_info, slots[i], estate,
+                                          false, false, nullptr, NIL
+#if PG_VERSION_NUM >= 160000
+                                          ,
+                                          false
+#endif
+    );
+    // Prepare() only accepts tables whose indexes are all checked at once
+    if (recheck != NIL) {
+      elog(ERROR, "unexpected deferred index check on \"%s\"",
+           RelationGetRelationName(rel));
+    }
+    ResetPerTupleExprContext(estate);
+  }
+}
+
+duckdb::unique_ptr<DirectMetadataInsert>
+DirectMetadataInsert::Prepare(const MetadataStatement &stmt) {
+  if (!stmt.is_insert) {
+    return nullptr;
+  }
+
+  PostgresScopedStackReset scoped_stack_reset;
+
+  Oid relid = ResolveTarget(stmt.target);
+  if (!OidIsValid(relid)) {
+    return nullptr;
+  }
+  auto insert = duckdb::unique_ptr<DirectMetadataInsert>(
+      new DirectMetadataInsert(table_open(relid, NoLock)));
+  Relation rel = insert->rel;
+  if (!SupportsDirectInsert(rel) ||
+      !ResolveTargetColumns(rel, stmt.columns, insert->attnums)) {
+    return nullptr;
+  }
+  TupleDesc tupdesc = RelationGetDescr(rel);
+
+  // Parse every row up front, so that falling back to SQL never happens
+  // halfway through
+  insert->rows.reserve(stmt.rows.size());
+  for (auto &row_text : stmt.rows) {
+    duckdb::vector<LiteralValue> row;
+    if (!ParseLiteralRow(row_text, row) ||
+        row.size() != insert->attnums.size()) {
+      return nullptr;
+    }
+    for (idx_t i = 0; i < row.size(); i++) {
+      Form_pg_attribute attr = TupleDescAttr(tupdesc, insert->attnums[i] - 1);
+      if ((row[i].kind == LiteralKind::NULL_VALUE && attr->attnotnull) ||
+          !LiteralFitsColumn(row[i], attr->atttypid)) {
+        // Let the executor raise the error
+        return nullptr;
+      }
+    }
+    insert->rows.push_back(std::move(row));
+  }
+  return insert;
+}
+
+DirectMetadataInsert::DirectMetadataInsert(Relation rel_) : rel(rel_) {}
+
+DirectMetadataInsert::~DirectMetadataInsert() {
+  // Keep the lock until the end of the transaction, as the executor does
+  if (rel) {
+    table_close(rel, NoLock);
+  }
+}
+
+void DirectMetadataInsert::Execute() {
+  PostgresScopedStackReset scoped_stack_reset;
+  UnsafeCommandIdGuard command_id_guard;
+  PushActiveSnapshot(GetTransactionSnapshot());
+
+  TupleDesc tupdesc = RelationGetDescr(rel);
+  duckdb::vector<FmgrInfo> input_funcs(tupdesc->natts);
+  duckdb::vector<Oid> typioparams(tupdesc->natts);
+  for (auto attnum : attnums) {
+    Oid typinput;
+    getTypeInputInfo(TupleDescAttr(tupdesc, attnum - 1)->atttypid, &typinput,
+                     &typioparams[attnum - 1]);
+    fmgr_info(typinput, &input_funcs[attnum - 1]);
+  }
+
+  EState *estate = CreateExecutorState();
+  estate->es_snapshot = GetActiveSnapshot();
+  ResultRelInfo *result_rel_info = makeNode(ResultRelInfo);
+  InitResultRelInfo(result_rel_info, rel, 1, nullptr, 0);
+  ExecOpenIndices(result_rel_info, false);
+
+  duckdb::vector<TupleTableSlot *> slots(
+      duckdb::MinValue<idx_t>(rows.size(), MULTI_INSERT_BATCH_SIZE));
+  for (auto &slot : slots) {
+    slot = MakeSingleTupleTableSlot(tupdesc, table_slot_callbacks(rel));
+  }
+  int num_slots = 0;
+
+  MemoryContext batch_context = AllocSetContextCreate(
+      CurrentMemoryContext, "DuckLake metadata insert",
+      ALLOCSET_DEFAULT_SIZES);
+  MemoryContext old_context = MemoryContextSwitchTo(batch_context);
+
+  for (auto &row : rows) {
+    TupleTableSlot *slot = slots[num_slots];
+    ExecClearTuple(slot);
+    memset(slot->tts_isnull, true, tupdesc->natts * sizeof(bool));
+    for (idx_t i = 0; i < row.size(); i++) {
+      int att = attnums[i] - 1;
+      if (row[i].kind == LiteralKind::NULL_VALUE) {
+        continue;
+      }
+      Form_pg_attribute attr = TupleDescAttr(tupdesc, att);
+      slot->tts_values[att] =
+          InputFunctionCall(&input_funcs[att], row[i].text.data(),
+                            typioparams[att], attr->atttypmod);
+      slot->tts_isnull[att] = false;
+    }
+    ExecStoreVirtualTuple(slot);
+
+    if (++num_slots == static_cast<int>(slots.size())) {
+      InsertSlots(result_rel_info, estate, slots.data(), num_slots);
+      for (int i = 0; i < num_slots; i++) {
+        ExecClearTuple(slots[i]);
+      }
+      num_slots = 0;
+      MemoryContextReset(batch_context);
+    }
+  }
+  if (num_slots > 0) {
+    InsertSlots(result_rel_info, estate, slots.data(), num_slots);
+  }
+
+  MemoryContextSwitchTo(old_context);
+  for (auto &slot : slots) {
+    ExecDropSingleTupleTableSlot(slot);
+  }
+  MemoryContextDelete(batch_context);
+  ExecCloseIndices(result_rel_info);
+  FreeExecutorState(estate);
+  PopActiveSnapshot();
+
+  // Make the rows visible to the statements that follow
+  CommandCounterIncrement();
+}
+
+} // namespace pgducklake
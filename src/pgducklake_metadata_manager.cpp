@@ -1,228 +1,323 @@
 #include "pgducklake/pgducklake_metadata_manager.hpp"
 
 // DuckDB headers first
-#include "duckdb/common/allocator.hpp"
-#include "duckdb/common/enums/statement_type.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/common/set.hpp"
 #include "duckdb/common/types.hpp"
-#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/types/value.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/unordered_map.hpp"
 #include "duckdb/main/client_context.hpp"
-#include "duckdb/main/materialized_query_result.hpp"
 #include <duckdb/common/string_util.hpp>
 
 #include "common/ducklake_util.hpp"
 
-// Our vendored type conversion utilities
-#include "pgducklake/pgducklake_pg_types.hpp"
+#include "pgducklake/pgducklake_catalog_cache.hpp"
+#include "pgducklake/pgducklake_metadata_batch.hpp"
+#include "pgducklake/pgducklake_metadata_scan.hpp"
+#include "pgducklake/pgducklake_shared_snapshot.hpp"
+#include "pgducklake/pgducklake_spi.hpp"
 
 // PostgreSQL headers
 extern "C" {
 #include "postgres.h"
 
 #include "access/genam.h"
+#include "access/htup_details.h"
 #include "access/skey.h"
 #include "access/table.h"
 #include "catalog/pg_class.h"
 #include "catalog/pg_namespace.h"
-#include "executor/spi.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/builtins.h"
 #include "utils/elog.h"
 #include "utils/fmgroids.h"
-#include "utils/guc.h"
-#include "utils/snapmgr.h"
+#include "utils/inval.h"
 #include "utils/syscache.h"
+#include "utils/tuplestore.h"
 }
 
 // Include after PostgreSQL headers (since these also include postgres.h)
 #include "pgducklake/utility/cpp_wrapper.hpp"
-#include "pgducklake/utility/unsafe_command_id_guard.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 
 namespace pgducklake {
-static duckdb::StatementType ConvertSPIResultToDuckStatementType(int result) {
-  switch (result) {
-  case SPI_OK_UTILITY:
-    return duckdb::StatementType::EXECUTE_STATEMENT;
-  case SPI_OK_SELECT:
-  case SPI_OK_SELINTO:
-    return duckdb::StatementType::SELECT_STATEMENT;
-  case SPI_OK_INSERT:
-  case SPI_OK_INSERT_RETURNING:
-    return duckdb::StatementType::INSERT_STATEMENT;
-  case SPI_OK_DELETE:
-  case SPI_OK_DELETE_RETURNING:
-    return duckdb::StatementType::DELETE_STATEMENT;
-  case SPI_OK_UPDATE:
-  case SPI_OK_UPDATE_RETURNING:
-    return duckdb::StatementType::UPDATE_STATEMENT;
-  default:
-    // For now, we should not use other types query in SPI.
-    return duckdb::StatementType::INVALID_STATEMENT;
-  }
-}
-
-static void InsertSPITupleTableIntoChunk(duckdb::DataChunk &output,
-                                         SPITupleTable *tuptable,
-                                         idx_t start_idx, int num_tuples) {
-  D_ASSERT(tuptable);
-  D_ASSERT(start_idx + num_tuples <= tuptable->numvals);
-
-  if (num_tuples == 0) {
-    return;
-  }
+PgDuckLakeMetadataManager::PgDuckLakeMetadataManager(
+    duckdb::DuckLakeTransaction &transaction_)
+    : DuckLakeMetadataManager(transaction_) {
+  // The manager lives as long as its DuckLake transaction
+  BeginMetadataReadScope();
+}
 
-  int natts = tuptable->tupdesc->natts;
-
-  for (int duckdb_output_index = 0; duckdb_output_index < natts;
-       duckdb_output_index++) {
-    auto &result = output.data[duckdb_output_index];
-    auto attr = TupleDescAttr(tuptable->tupdesc, duckdb_output_index);
-
-    for (int row = 0; row < num_tuples; row++) {
-      HeapTuple tuple = tuptable->vals[start_idx + row];
-      bool isnull = false;
-      Datum datum = SPI_getbinval(tuple, tuptable->tupdesc,
-                                  duckdb_output_index + 1, &isnull);
-      if (isnull) {
-        auto &array_mask = duckdb::FlatVector::Validity(result);
-        array_mask.SetInvalid(row);
-      } else {
-        if (attr->attlen == -1) {
-          bool should_free = false;
-          Datum detoasted_value = DetoastPostgresDatum(
-              reinterpret_cast<varlena *>(datum), &should_free);
-          ConvertPostgresToDuckValue(attr->atttypid, detoasted_value, result,
-                                     row);
-          if (should_free) {
-            pfree(DatumGetPointer(detoasted_value));
-          }
-        } else {
-          ConvertPostgresToDuckValue(attr->atttypid, datum, result, row);
-        }
-      }
+PgDuckLakeMetadataManager::~PgDuckLakeMetadataManager() {
+  EndMetadataReadScope();
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+PgDuckLakeMetadataManager::Query(duckdb::string query) {
+  DuckLakeMetadataManager::FillCatalogArgs(query, transaction.GetCatalog());
+  DuckLakeMetadataManager::FillSnapshotCommitArgs(query,
+                                                  transaction.GetCommitInfo());
+  // Snapshots by id, for time travel, are read straight from the index
+  if (IsSelectQuery(query)) {
+    if (auto result = ScanPointLookup(query)) {
+      return result;
     }
   }
+  // Execute the query using SPI and wrap the result
+  return ExecuteSPIRead(query);
 }
 
-static duckdb::unique_ptr<duckdb::QueryResult>
-CreateSPIResult(const duckdb::string &query) {
-  elog(DEBUG1, "Creating SPI result for query: %s", query.c_str());
-
-  PostgresScopedStackReset scoped_stack_reset;
-  UnsafeCommandIdGuard command_id_guard;
+duckdb::unique_ptr<duckdb::QueryResult>
+PgDuckLakeMetadataManager::Query(duckdb::DuckLakeSnapshot snapshot,
+                                 duckdb::string query) {
+  return RunQuery(snapshot, std::move(query), false, nullptr);
+}
 
-  SPI_connect();
-  PushActiveSnapshot(GetTransactionSnapshot());
+duckdb::unique_ptr<duckdb::QueryResult>
+PgDuckLakeMetadataManager::StreamQuery(duckdb::DuckLakeSnapshot snapshot,
+                                       duckdb::string query,
+                                       const SnapshotParams *params) {
+  return RunQuery(snapshot, std::move(query), true, params);
+}
 
-  auto save_nestlevel = NewGUCNestLevel();
-  SetConfigOption("duckdb.force_execution", "false", PGC_USERSET,
-                  PGC_S_SESSION);
+// The latest snapshot: as published in shared memory by the last commit when
+// this transaction may use that, read from ducklake_snapshot otherwise
+static bool GetLatestSnapshot(duckdb::DuckLakeSnapshot &snapshot) {
+  return SharedLatestSnapshot::Lookup(snapshot) ||
+         ScanLatestSnapshot(snapshot);
+}
 
-  // Execute the query in read-only mode
-  int ret = SPI_execute(query.c_str(), false, 0);
+/*
+ * At the latest snapshot, a row is visible exactly when it has not ended
+ * yet: every ended row was ended by a snapshot we can see. Reads of the
+ * latest snapshot, which are nearly all of them, thus get their range
+ * predicates replaced by "end_snapshot IS NULL", which the indexes
+ * created at initialization answer from the current rows alone, instead of
+ * going through the whole history.
+ *
+ * The rewritten text only depends on the query template, so it is worked out
+ * once per template, by plain string matching, and kept. Templates with ids
+ * filled in are many, so the whole map is dropped once it grows too large.
+ */
+constexpr size_t LATEST_REWRITE_MAX_ENTRIES = 1024;
+
+// Rewritten query by template, empty if there is nothing to rewrite
+static duckdb::unordered_map<duckdb::string, duckdb::string> latest_rewrites;
+
+static bool IsIdentChar(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
 
-  if (ret < 0) {
-    elog(ERROR, "SPI_execute failed: %s", SPI_result_code_string(ret));
+// Replace "{SNAPSHOT_ID} >= t.begin_snapshot AND ({SNAPSHOT_ID} <
+// t.end_snapshot OR t.end_snapshot IS NULL)", with the same optional
+// qualifier throughout, by "t.end_snapshot IS NULL". Empty if none is found.
+static duckdb::string RewriteVisibleAtSnapshot(const duckdb::string &query) {
+  static const duckdb::string prefix = "{SNAPSHOT_ID} >= ";
+  duckdb::string result;
+  bool replaced = false;
+  idx_t pos = 0;
+  for (auto start = query.find(prefix); start != duckdb::string::npos;
+       start = query.find(prefix, pos)) {
+    idx_t qualifier_start = start + prefix.size();
+    idx_t qualifier_end = qualifier_start;
+    while (qualifier_end < query.size() && IsIdentChar(query[qualifier_end])) {
+      qualifier_end++;
+    }
+    duckdb::string qualifier;
+    if (qualifier_end < query.size() && query[qualifier_end] == '.') {
+      qualifier = query.substr(qualifier_start,
+                               qualifier_end + 1 - qualifier_start);
+    }
+    auto predicate = qualifier + "begin_snapshot AND ({SNAPSHOT_ID} < " +
+                     qualifier + "end_snapshot OR " + qualifier +
+                     "end_snapshot IS NULL)";
+    if (query.compare(qualifier_start, predicate.size(), predicate) == 0) {
+      result.append(query, pos, start - pos);
+      result += qualifier + "end_snapshot IS NULL";
+      pos = qualifier_start + predicate.size();
+      replaced = true;
+    } else {
+      result.append(query, pos, qualifier_start - pos);
+      pos = qualifier_start;
+    }
   }
-
-  // Get the result table
-  SPITupleTable *tuptable = SPI_tuptable;
-  if (!tuptable) {
-    AtEOXact_GUC(false, save_nestlevel);
-    PopActiveSnapshot();
-    SPI_finish();
-
-    // Return an empty result
-    duckdb::vector<duckdb::string> names;
-    duckdb::StatementProperties properties;
-    duckdb::ClientProperties client_properties;
-
-    // Create an empty ColumnDataCollection instead of passing nullptr
-    auto &allocator = duckdb::Allocator::DefaultAllocator();
-    auto empty_collection =
-        duckdb::make_uniq<duckdb::ColumnDataCollection>(allocator);
-
-    return duckdb::make_uniq<duckdb::MaterializedQueryResult>(
-        ConvertSPIResultToDuckStatementType(ret), properties, names,
-        std::move(empty_collection), client_properties);
+  if (!replaced) {
+    return duckdb::string();
   }
+  result.append(query, pos, duckdb::string::npos);
+  return result;
+}
 
-  TupleDesc tupdesc = tuptable->tupdesc;
-  int num_columns = tupdesc->natts;
-  uint64 num_rows = tuptable->numvals;
-
-  // Convert column types and names
-  duckdb::vector<duckdb::LogicalType> types;
-  duckdb::vector<duckdb::string> names;
-
-  for (int i = 0; i < num_columns; i++) {
-    Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
-
-    D_ASSERT(!attr->attisdropped);
-
-    // Get column name
-    names.push_back(NameStr(attr->attname));
-
-    // Convert Postgres type to DuckDB type
-    types.push_back(ConvertPostgresToDuckColumnType(attr));
+static void RewriteForLatestSnapshot(duckdb::string &query,
+                                     const duckdb::DuckLakeSnapshot &snapshot) {
+  auto entry = latest_rewrites.find(query);
+  if (entry == latest_rewrites.end()) {
+    if (latest_rewrites.size() >= LATEST_REWRITE_MAX_ENTRIES) {
+      latest_rewrites.clear();
+    }
+    entry = latest_rewrites.emplace(query, RewriteVisibleAtSnapshot(query))
+                .first;
   }
-
-  // Create a ColumnDataCollection to store the results
-  duckdb::ClientProperties client_properties;
-  auto &allocator = duckdb::Allocator::DefaultAllocator();
-  auto collection_p =
-      duckdb::make_uniq<duckdb::ColumnDataCollection>(allocator, types);
-
-  // Convert SPI rows to DuckDB DataChunks and append them
-  for (idx_t row_idx = 0; row_idx < num_rows; row_idx += STANDARD_VECTOR_SIZE) {
-    idx_t chunk_size =
-        duckdb::MinValue<int>(STANDARD_VECTOR_SIZE, num_rows - row_idx);
-    auto chunk = duckdb::make_uniq<duckdb::DataChunk>();
-    chunk->Initialize(allocator, types, chunk_size);
-    InsertSPITupleTableIntoChunk(*chunk, tuptable, row_idx, chunk_size);
-
-    chunk->SetCardinality(chunk_size);
-    collection_p->Append(*chunk);
+  if (entry->second.empty()) {
+    return;
+  }
+  // Only the published latest snapshot is cheap enough to check for every
+  // read; without it, the range predicates are just as correct.
+  duckdb::DuckLakeSnapshot latest(0, 0, 0, 0);
+  if (!SharedLatestSnapshot::Lookup(latest) ||
+      latest.snapshot_id != snapshot.snapshot_id) {
+    return;
   }
+  query = entry->second;
+}
 
-  AtEOXact_GUC(false, save_nestlevel);
-  PopActiveSnapshot();
-  SPI_finish();
+// Whether `query` only reads the file lists and statistics of tables
+static bool IsFileOrStatsRead(const duckdb::string &query) {
+  static const char *const relnames[] = {
+      "ducklake_data_file",         "ducklake_delete_file",
+      "ducklake_file_column_stats", "ducklake_file_partition_value",
+      "ducklake_table_stats",       "ducklake_table_column_stats"};
+  bool found = false;
+  for (auto pos = query.find("ducklake_"); pos != duckdb::string::npos;
+       pos = query.find("ducklake_", pos + 1)) {
+    if (pos > 0 && IsIdentChar(query[pos - 1])) {
+      continue;
+    }
+    idx_t end = pos;
+    while (end < query.size() && IsIdentChar(query[end])) {
+      end++;
+    }
+    auto name = query.substr(pos, end - pos);
+    if (std::find(std::begin(relnames), std::end(relnames), name) ==
+        std::end(relnames)) {
+      return false;
+    }
+    found = true;
+  }
+  return found;
+}
 
-  // Create and return the MaterializedQueryResult
-  duckdb::StatementProperties properties;
-  return duckdb::make_uniq<duckdb::MaterializedQueryResult>(
-      duckdb::StatementType::SELECT_STATEMENT, properties, names,
-      std::move(collection_p), client_properties);
+duckdb::unique_ptr<duckdb::QueryResult>
+PgDuckLakeMetadataManager::RunQuery(duckdb::DuckLakeSnapshot snapshot,
+                                    duckdb::string query, bool stream,
+                                    const SnapshotParams *extra_params) {
+  DuckLakeMetadataManager::FillCatalogArgs(query, transaction.GetCatalog());
+  // Rows fetched by id, such as a single table at the snapshot, skip SPI
+  if (!extra_params && IsSelectQuery(query)) {
+    if (auto result = ScanPointLookup(query, snapshot.snapshot_id)) {
+      return result;
+    }
+  }
+  if (!stream && IsSelectQuery(query) && IsFileOrStatsRead(query)) {
+    // Kept whole when cached, streamed otherwise: these results grow with
+    // the number of files, and DuckLake only iterates them
+    idx_t file_list_table_id = 0;
+    if (!extra_params && FileListCache::IsActive() &&
+        FileListCache::IsCacheable(query, file_list_table_id)) {
+      return QueryFileList(snapshot, query, file_list_table_id);
+    }
+    stream = true;
+  }
+  return ExecuteRead(snapshot, std::move(query), stream, extra_params);
 }
 
-PgDuckLakeMetadataManager::PgDuckLakeMetadataManager(
-    duckdb::DuckLakeTransaction &transaction_)
-    : DuckLakeMetadataManager(transaction_) {}
+// File list reads this backend answered from the cache as is, patched with
+// the rows of the files that changed, or read in full, for
+// ducklake._file_list_loads()
+static int64 file_list_hits = 0;
+static int64 file_list_refreshes = 0;
+static int64 file_list_full_reads = 0;
 
-PgDuckLakeMetadataManager::~PgDuckLakeMetadataManager() {}
+duckdb::unique_ptr<duckdb::QueryResult>
+PgDuckLakeMetadataManager::QueryFileList(duckdb::DuckLakeSnapshot snapshot,
+                                         const duckdb::string &query,
+                                         idx_t table_id) {
+  // File lists of a table are reused for as long as none of its files
+  // changed, and otherwise only the rows of the files that did are read
+  duckdb::optional_idx file_column;
+  duckdb::set<idx_t> changed_files;
+  auto cached = FileListCache::Lookup(query, table_id, snapshot.snapshot_id,
+                                      file_column, changed_files);
+  if (cached) {
+    file_list_hits++;
+    return cached;
+  }
+  if (file_column.IsValid()) {
+    auto body = query;
+    while (!body.empty() &&
+           (isspace(static_cast<unsigned char>(body.back())) ||
+            body.back() == ';')) {
+      body.pop_back();
+    }
+    // Columns up to the data file id are renamed, since a file list may
+    // repeat a column name
+    duckdb::string columns;
+    for (idx_t i = 0; i <= file_column.GetIndex(); i++) {
+      columns += (i ? ", file_list_" : "file_list_") + std::to_string(i);
+    }
+    SnapshotParams params(snapshot);
+    auto ids = params.AddBigintArray(changed_files);
+    auto rows = ExecuteRead(
+        snapshot,
+        "SELECT * FROM (" + body + ") AS file_list(" + columns +
+            ") WHERE file_list_" + std::to_string(file_column.GetIndex()) +
+            " = ANY(" + ids + ")",
+        false, &params);
+    auto refreshed =
+        FileListCache::Refresh(query, table_id, snapshot.snapshot_id,
+                               changed_files, std::move(rows));
+    if (refreshed) {
+      file_list_refreshes++;
+      return refreshed;
+    }
+  }
+  file_list_full_reads++;
+  return FileListCache::Store(query, table_id, snapshot.snapshot_id,
+                              ExecuteRead(snapshot, query, false, nullptr));
+}
 
 duckdb::unique_ptr<duckdb::QueryResult>
-PgDuckLakeMetadataManager::Query(duckdb::string query) {
-  DuckLakeMetadataManager::FillCatalogArgs(query, transaction.GetCatalog());
+PgDuckLakeMetadataManager::ExecuteRead(duckdb::DuckLakeSnapshot snapshot,
+                                       duckdb::string query, bool stream,
+                                       const SnapshotParams *extra_params) {
+  if (IsSelectQuery(query)) {
+    RewriteForLatestSnapshot(query, snapshot);
+  }
+  // Reads bind the snapshot as plan parameters, everything else gets the
+  // values filled into the query text.
+  bool parameterized = IsSelectQuery(query) && ParameterizeSnapshotArgs(query);
+  if (!parameterized) {
+    DuckLakeMetadataManager::FillSnapshotArgs(query, snapshot);
+  }
   DuckLakeMetadataManager::FillSnapshotCommitArgs(query,
                                                   transaction.GetCommitInfo());
-  // Execute the query using SPI and wrap the result
-  return CreateSPIResult(query);
-}
 
-duckdb::unique_ptr<duckdb::QueryResult>
-PgDuckLakeMetadataManager::Query(duckdb::DuckLakeSnapshot snapshot,
-                                 duckdb::string query) {
-  // Fill snapshot args into the query
-  DuckLakeMetadataManager::FillSnapshotArgs(query, snapshot);
-  return Query(query);
+  // Values bound beyond the snapshot are referenced as $5 onwards, whether or
+  // not the snapshot itself could be bound.
+  SnapshotParams params =
+      extra_params ? *extra_params : SnapshotParams(snapshot);
+  bool has_extra_params = params.num_params > NUM_SNAPSHOT_PARAMS;
+  auto *bound_params = parameterized || has_extra_params ? &params : nullptr;
+  if (stream) {
+    return OpenSPICursor(query, bound_params);
+  }
+  return ExecuteSPIRead(query, bound_params);
 }
 
 duckdb::unique_ptr<duckdb::QueryResult>
 PgDuckLakeMetadataManager::Execute(duckdb::string query) {
-  return Query(query);
+  DuckLakeMetadataManager::FillCatalogArgs(query, transaction.GetCatalog());
+  DuckLakeMetadataManager::FillSnapshotCommitArgs(query,
+                                                  transaction.GetCommitInfo());
+  // A commit writes its metadata as one batch of mostly single-row INSERTs;
+  // run them as one bulk insert per table instead.
+  return ExecuteMetadataBatch(CoalesceMetadataBatch(query));
 }
 
 duckdb::unique_ptr<duckdb::QueryResult>
@@ -230,10 +325,75 @@ PgDuckLakeMetadataManager::Execute(duckdb::DuckLakeSnapshot snapshot,
                                    duckdb::string query) {
   // Fill snapshot args into the query
   DuckLakeMetadataManager::FillSnapshotArgs(query, snapshot);
-  return Query(query);
+  return Execute(query);
+}
+
+duckdb::unique_ptr<duckdb::DuckLakeSnapshot>
+PgDuckLakeMetadataManager::GetSnapshot() {
+  duckdb::DuckLakeSnapshot snapshot(0, 0, 0, 0);
+  if (!GetLatestSnapshot(snapshot)) {
+    return DuckLakeMetadataManager::GetSnapshot();
+  }
+  return duckdb::make_uniq<duckdb::DuckLakeSnapshot>(snapshot);
+}
+
+/*
+ * Cached answer of IsInitialized(), reset by cache invalidation:
+ *  - any namespace change, since the ducklake schema may have been created,
+ *    dropped or renamed;
+ *  - while uninitialized, any relcache invalidation, since it may be the
+ *    creation of the first ducklake_* table;
+ *  - while initialized, an invalidation of the table we found, which covers
+ *    its drop and rename.
+ */
+enum class InitializedState { UNKNOWN, INITIALIZED, UNINITIALIZED };
+
+static InitializedState initialized_state = InitializedState::UNKNOWN;
+static Oid initialized_relid = InvalidOid;
+// Bumped by every invalidation, to detect one arriving during the lookup
+static uint64 initialized_invalidations = 0;
+
+static void InvalidateInitializedRelcache(Datum /*arg*/, Oid relid) {
+  if (initialized_state != InitializedState::INITIALIZED ||
+      !OidIsValid(relid) || relid == initialized_relid) {
+    initialized_state = InitializedState::UNKNOWN;
+    initialized_invalidations++;
+  }
+}
+
+static void InvalidateInitializedSyscache(Datum /*arg*/, int /*cacheid*/,
+                                          uint32 /*hashvalue*/) {
+  initialized_state = InitializedState::UNKNOWN;
+  initialized_invalidations++;
 }
 
+static bool LookupInitialized(Oid *found_relid);
+
 bool PgDuckLakeMetadataManager::IsInitialized() {
+  static bool callbacks_registered = false;
+  if (!callbacks_registered) {
+    CacheRegisterRelcacheCallback(InvalidateInitializedRelcache, (Datum)0);
+    CacheRegisterSyscacheCallback(NAMESPACEOID, InvalidateInitializedSyscache,
+                                  (Datum)0);
+    callbacks_registered = true;
+  }
+
+  if (initialized_state != InitializedState::UNKNOWN) {
+    return initialized_state == InitializedState::INITIALIZED;
+  }
+
+  uint64 invalidations = initialized_invalidations;
+  Oid relid = InvalidOid;
+  bool found = LookupInitialized(&relid);
+  if (invalidations == initialized_invalidations) {
+    initialized_relid = relid;
+    initialized_state = found ? InitializedState::INITIALIZED
+                              : InitializedState::UNINITIALIZED;
+  }
+  return found;
+}
+
+static bool LookupInitialized(Oid *found_relid) {
 
   auto tup = SearchSysCache1(NAMESPACENAME, CStringGetDatum("ducklake"));
 
@@ -264,6 +424,7 @@ bool PgDuckLakeMetadataManager::IsInitialized() {
     if (strncmp(relname, "ducklake_", 9) == 0 &&
         classForm->relkind == RELKIND_RELATION) {
       found = true;
+      *found_relid = classForm->oid;
       break;
     }
   }
@@ -274,31 +435,145 @@ bool PgDuckLakeMetadataManager::IsInitialized() {
   return found;
 }
 
-static bool AddChildColumn(duckdb::vector<duckdb::DuckLakeColumnInfo> &columns,
-                           duckdb::FieldIndex parent_id,
-                           duckdb::DuckLakeColumnInfo &column_info) {
-  for (auto &col : columns) {
-    if (col.id == parent_id) {
-      col.children.push_back(std::move(column_info));
-      return true;
+/*
+ * Typed reads of one column of a result chunk. Catalogs of many tables come
+ * in many rows; reading the vectors directly saves boxing every cell into a
+ * duckdb::Value. Nested values (tags, inlined tables) still go through Value.
+ */
+class ChunkColumn {
+public:
+  ChunkColumn(duckdb::DataChunk &chunk, idx_t column)
+      : vector(chunk.data[column]) {
+    vector.ToUnifiedFormat(chunk.size(), format);
+  }
+
+  bool IsNull(idx_t row) const {
+    return !format.validity.RowIsValid(format.sel->get_index(row));
+  }
+
+  idx_t GetId(idx_t row) const {
+    auto idx = format.sel->get_index(row);
+    switch (vector.GetType().InternalType()) {
+    case duckdb::PhysicalType::INT64:
+      return duckdb::UnifiedVectorFormat::GetData<int64_t>(format)[idx];
+    case duckdb::PhysicalType::INT32:
+      return duckdb::UnifiedVectorFormat::GetData<int32_t>(format)[idx];
+    default:
+      return vector.GetValue(row).GetValue<uint64_t>();
+    }
+  }
+
+  bool GetBool(idx_t row) const {
+    if (vector.GetType().InternalType() == duckdb::PhysicalType::BOOL) {
+      return duckdb::UnifiedVectorFormat::GetData<bool>(
+          format)[format.sel->get_index(row)];
+    }
+    return vector.GetValue(row).GetValue<bool>();
+  }
+
+  duckdb::string GetString(idx_t row) const {
+    if (vector.GetType().InternalType() == duckdb::PhysicalType::VARCHAR) {
+      return duckdb::UnifiedVectorFormat::GetData<duckdb::string_t>(
+                 format)[format.sel->get_index(row)]
+          .GetString();
+    }
+    return vector.GetValue(row).ToString();
+  }
+
+  duckdb::Value GetValue(idx_t row) const { return vector.GetValue(row); }
+
+private:
+  duckdb::Vector &vector;
+  duckdb::UnifiedVectorFormat format;
+};
+
+static duckdb::vector<ChunkColumn> GetChunkColumns(duckdb::DataChunk &chunk) {
+  duckdb::vector<ChunkColumn> columns;
+  columns.reserve(chunk.ColumnCount());
+  for (idx_t i = 0; i < chunk.ColumnCount(); i++) {
+    columns.emplace_back(chunk, i);
+  }
+  return columns;
+}
+
+/*
+ * Assembles the nested columns of a table. Parents are found through a hash
+ * map rather than by searching the tree, and need not come before their
+ * children; siblings keep the order in which they were added.
+ */
+class ColumnTreeBuilder {
+public:
+  void AddColumn(duckdb::DuckLakeColumnInfo column,
+                 duckdb::optional_idx parent_id) {
+    columns.push_back(std::move(column));
+    parent_ids.push_back(parent_id);
+  }
+
+  bool IsEmpty() const { return columns.empty(); }
+
+  duckdb::vector<duckdb::DuckLakeColumnInfo> Build() {
+    duckdb::unordered_map<idx_t, idx_t> positions;
+    for (idx_t i = 0; i < columns.size(); i++) {
+      positions[columns[i].id.index] = i;
+    }
+    duckdb::vector<duckdb::vector<idx_t>> children(columns.size());
+    duckdb::vector<idx_t> roots;
+    for (idx_t i = 0; i < columns.size(); i++) {
+      if (!parent_ids[i].IsValid()) {
+        roots.push_back(i);
+        continue;
+      }
+      auto parent = positions.find(parent_ids[i].GetIndex());
+      if (parent == positions.end() || parent->second == i) {
+        throw duckdb::InvalidInputException(
+            "Failed to load DuckLake - Could not find parent column for column "
+            "%s",
+            columns[i].name);
+      }
+      children[parent->second].push_back(i);
     }
-    if (AddChildColumn(col.children, parent_id, column_info)) {
-      return true;
+    duckdb::vector<duckdb::DuckLakeColumnInfo> result;
+    for (auto root : roots) {
+      result.push_back(Take(root, children));
     }
+    return result;
+  }
+
+private:
+  duckdb::DuckLakeColumnInfo
+  Take(idx_t position, const duckdb::vector<duckdb::vector<idx_t>> &children) {
+    auto column = std::move(columns[position]);
+    for (auto child : children[position]) {
+      column.children.push_back(Take(child, children));
+    }
+    return column;
+  }
+
+  duckdb::vector<duckdb::DuckLakeColumnInfo> columns;
+  duckdb::vector<duckdb::optional_idx> parent_ids;
+};
+
+// Tags and inlined tables arrive as arrays of the ducklake._tag and
+// ducklake._inlined_table composite types, which the bridge decodes into
+// LIST<STRUCT> values. Anything else, e.g. JSON, is cast to that.
+static duckdb::Value CastToList(const duckdb::Value &value,
+                                const duckdb::LogicalType &list_type) {
+  if (value.type().id() == duckdb::LogicalTypeId::LIST) {
+    return value;
   }
-  return false;
+  return value.DefaultCastAs(list_type);
 }
 
 duckdb::vector<duckdb::DuckLakeTag>
 PgDuckLakeMetadataManager::LoadTags(const duckdb::Value &tag_map) const {
-
   static const duckdb::LogicalType tags_type =
-      duckdb::LogicalType::STRUCT({{"key", duckdb::LogicalType::VARCHAR},
-                                   {"value", duckdb::LogicalType::VARCHAR}});
+      duckdb::LogicalType::LIST(duckdb::LogicalType::STRUCT(
+          {{"key", duckdb::LogicalType::VARCHAR},
+           {"value", duckdb::LogicalType::VARCHAR}}));
 
   duckdb::vector<duckdb::DuckLakeTag> result;
-  for (auto &tag : duckdb::ListValue::GetChildren(tag_map)) {
-    auto tag_struct = tag.DefaultCastAs(tags_type);
+  auto tags = CastToList(tag_map, tags_type);
+  for (auto &tag : duckdb::ListValue::GetChildren(tags)) {
     auto &struct_children = duckdb::StructValue::GetChildren(tag);
     if (struct_children[1].IsNull()) {
       continue;
@@ -314,15 +589,15 @@ PgDuckLakeMetadataManager::LoadTags(const duckdb::Value &tag_map) const {
 duckdb::vector<duckdb::DuckLakeInlinedTableInfo>
 PgDuckLakeMetadataManager::LoadInlinedDataTables(
     const duckdb::Value &list) const {
-
-  static const duckdb::LogicalType val_type = duckdb::LogicalType::STRUCT(
-      {{"name", duckdb::LogicalType::VARCHAR},
-       {"schema_version", duckdb::LogicalType::BIGINT}});
+  static const duckdb::LogicalType list_type =
+      duckdb::LogicalType::LIST(duckdb::LogicalType::STRUCT(
+          {{"name", duckdb::LogicalType::VARCHAR},
+           {"schema_version", duckdb::LogicalType::BIGINT}}));
 
   duckdb::vector<duckdb::DuckLakeInlinedTableInfo> result;
-  for (auto &val : duckdb::ListValue::GetChildren(list)) {
-    auto val_struct = val.DefaultCastAs(val_type);
-    auto &struct_children = duckdb::StructValue::GetChildren(val_struct);
+  auto inlined = CastToList(list, list_type);
+  for (auto &val : duckdb::ListValue::GetChildren(inlined)) {
+    auto &struct_children = duckdb::StructValue::GetChildren(val);
     duckdb::DuckLakeInlinedTableInfo inlined_data_table;
     inlined_data_table.table_name =
         duckdb::StringValue::Get(struct_children[0]);
@@ -341,230 +616,511 @@ PgDuckLakeMetadataManager::CastStatsToTarget(const duckdb::string &stats,
   return stats;
 }
 
+// Catalogs this backend patched from a cached one or read in full, for
+// ducklake._catalog_loads()
+static int64 catalog_refreshes = 0;
+static int64 catalog_full_loads = 0;
+
 duckdb::DuckLakeCatalogInfo PgDuckLakeMetadataManager::GetCatalogForSnapshot(
     duckdb::DuckLakeSnapshot snapshot) {
-  auto &ducklake_catalog = transaction.GetCatalog();
-  auto &base_data_path = ducklake_catalog.DataPath();
+  auto &base_data_path = transaction.GetCatalog().DataPath();
   duckdb::DuckLakeCatalogInfo catalog;
-  // load the schema information
-  auto result = Query(snapshot, R"(
-SELECT schema_id, schema_uuid::VARCHAR, schema_name, path, path_is_relative
-FROM {METADATA_CATALOG}.ducklake_schema
-WHERE {SNAPSHOT_ID} >= begin_snapshot AND ({SNAPSHOT_ID} < end_snapshot OR end_snapshot IS NULL)
-)");
-  if (result->HasError()) {
-    result->GetErrorObject().Throw(
-        "Failed to get schema information from DuckLake: ");
+  if (CatalogCache::Lookup(snapshot.snapshot_id, base_data_path, catalog)) {
+    return catalog;
   }
-  duckdb::map<duckdb::SchemaIndex, idx_t> schema_map;
-  for (auto &row : *result) {
-    duckdb::DuckLakeSchemaInfo schema;
-    schema.id = duckdb::SchemaIndex(row.GetValue<uint64_t>(0));
-    schema.uuid = row.GetValue<duckdb::string>(1);
-    schema.name = row.GetValue<duckdb::string>(2);
-    if (row.IsNull(3)) {
-      // no path provided - fallback to base data path
-      schema.path = base_data_path;
+  idx_t base_snapshot_id;
+  if (CatalogCache::LookupPrevious(snapshot.snapshot_id, base_data_path,
+                                   base_snapshot_id, catalog)) {
+    RefreshCatalog(base_snapshot_id, snapshot, catalog);
+    catalog_refreshes++;
+  } else {
+    catalog = LoadCatalogForSnapshot(snapshot);
+    catalog_full_loads++;
+  }
+  CatalogCache::Store(snapshot.snapshot_id, base_data_path, catalog);
+  return catalog;
+}
+
+/*
+ * Read the catalog of `snapshot`. With tables of another snapshot in the
+ * TableInfoCache, only the tables that differ between the two are read, and
+ * the others taken from there; moving forward, the cache then follows.
+ */
+duckdb::DuckLakeCatalogInfo PgDuckLakeMetadataManager::LoadCatalogForSnapshot(
+    duckdb::DuckLakeSnapshot snapshot) {
+  duckdb::DuckLakeCatalogInfo catalog;
+  idx_t cached_snapshot_id;
+  if (!TableInfoCache::GetSnapshot(cached_snapshot_id)) {
+    LoadCatalog(snapshot, catalog, nullptr, nullptr, nullptr);
+    TableInfoCache::Update(snapshot.snapshot_id, nullptr, catalog.tables);
+    return catalog;
+  }
+
+  CatalogChanges changes;
+  if (cached_snapshot_id != snapshot.snapshot_id) {
+    LoadCatalogChanges(
+        snapshot, std::min<idx_t>(cached_snapshot_id, snapshot.snapshot_id),
+        std::max<idx_t>(cached_snapshot_id, snapshot.snapshot_id), changes);
+  }
+  duckdb::vector<duckdb::DuckLakeTableInfo> cached;
+  TableInfoCache::CopyTables(changes.table_ids, cached);
+  // The paths of tables derive from the path of their schema
+  auto &load_ids = changes.table_ids;
+  duckdb::vector<duckdb::DuckLakeTableInfo> kept;
+  for (auto &table : cached) {
+    if (changes.schema_ids.count(table.schema_id.index)) {
+      load_ids.insert(table.id.index);
     } else {
-      // path is provided - load it
-      duckdb::DuckLakePath path;
-      path.path = row.GetValue<duckdb::string>(3);
-      path.path_is_relative = row.GetValue<bool>(4);
-
-      schema.path = FromRelativePath(path);
-    }
-    schema_map[schema.id] = catalog.schemas.size();
-    catalog.schemas.push_back(std::move(schema));
-  }
-
-  // load the table information
-  result = Query(snapshot, R"(
-SELECT schema_id, tbl.table_id, table_uuid::VARCHAR, table_name,
-	(
-		SELECT array_agg(jsonb_build_object('key', key, 'value', value))
-		FROM {METADATA_CATALOG}.ducklake_tag tag
-		WHERE object_id=table_id AND
-		      {SNAPSHOT_ID} >= tag.begin_snapshot AND ({SNAPSHOT_ID} < tag.end_snapshot OR tag.end_snapshot IS NULL)
-	) AS tag,
-	(
-		SELECT array_agg(jsonb_build_object('name', table_name, 'schema_version', schema_version))
-		FROM {METADATA_CATALOG}.ducklake_inlined_data_tables inlined_data_tables
-		WHERE inlined_data_tables.table_id = tbl.table_id
-	) AS inlined_data_tables,
-	path, path_is_relative,
-	col.column_id, column_name, column_type, initial_default, default_value, nulls_allowed, parent_column,
-	(
-		SELECT array_agg(jsonb_build_object('key', key, 'value', value))
-		FROM {METADATA_CATALOG}.ducklake_column_tag col_tag
-		WHERE col_tag.table_id=tbl.table_id AND col_tag.column_id=col.column_id AND
-		      {SNAPSHOT_ID} >= col_tag.begin_snapshot AND ({SNAPSHOT_ID} < col_tag.end_snapshot OR col_tag.end_snapshot IS NULL)
-	) AS column_tags
-FROM {METADATA_CATALOG}.ducklake_table tbl
-LEFT JOIN {METADATA_CATALOG}.ducklake_column col USING (table_id)
-WHERE {SNAPSHOT_ID} >= tbl.begin_snapshot AND ({SNAPSHOT_ID} < tbl.end_snapshot OR tbl.end_snapshot IS NULL)
-  AND (({SNAPSHOT_ID} >= col.begin_snapshot AND ({SNAPSHOT_ID} < col.end_snapshot OR col.end_snapshot IS NULL)) OR column_id IS NULL)
-ORDER BY table_id, parent_column NULLS FIRST, column_order
-)");
+      kept.push_back(std::move(table));
+    }
+  }
+
+  LoadCatalog(snapshot, catalog, &load_ids, nullptr, nullptr);
+  if (snapshot.snapshot_id > cached_snapshot_id) {
+    TableInfoCache::Update(snapshot.snapshot_id, &load_ids, catalog.tables);
+  }
+  for (auto &table : kept) {
+    catalog.tables.push_back(std::move(table));
+  }
+  std::sort(catalog.tables.begin(), catalog.tables.end(),
+            [](const duckdb::DuckLakeTableInfo &a,
+               const duckdb::DuckLakeTableInfo &b) {
+              return a.id.index < b.id.index;
+            });
+
+  // Cached entries may predate a new inlined data table
+  if (!kept.empty()) {
+    RefreshInlinedDataTables(snapshot, catalog);
+  }
+  return catalog;
+}
+
+// Columns of ducklake._catalog_for_snapshot()
+enum CatalogColumn : idx_t {
+  CATALOG_SECTION,
+  CATALOG_ID,
+  CATALOG_PARENT_ID,
+  CATALOG_UUID,
+  CATALOG_NAME,
+  CATALOG_PATH,
+  CATALOG_PATH_IS_RELATIVE,
+  CATALOG_TAGS,
+  CATALOG_INLINED_DATA_TABLES,
+  CATALOG_COLUMN_TYPE,
+  CATALOG_INITIAL_DEFAULT,
+  CATALOG_DEFAULT_VALUE,
+  CATALOG_NULLS_ALLOWED,
+  CATALOG_PARENT_COLUMN,
+  CATALOG_DIALECT,
+  CATALOG_SQL,
+  CATALOG_COLUMN_ALIASES,
+  CATALOG_PARTITION_KEY_INDEX,
+  CATALOG_FIELD_ID,
+  CATALOG_TRANSFORM
+};
+
+enum CatalogSection : idx_t {
+  SECTION_SCHEMA = 0,
+  SECTION_TABLE = 1,
+  SECTION_COLUMN = 2,
+  SECTION_VIEW = 3,
+  SECTION_PARTITION = 4
+};
+
+/*
+ * All catalog reads go through ducklake._catalog_for_snapshot(), so that the
+ * catalog query exists once, and all sections are planned and executed
+ * together instead of one query per section. Id sets are bound as bigint[]
+ * arguments; an absent one selects all objects of its kind.
+ */
+void PgDuckLakeMetadataManager::LoadCatalog(
+    duckdb::DuckLakeSnapshot snapshot, duckdb::DuckLakeCatalogInfo &catalog,
+    const duckdb::set<idx_t> *table_ids, const duckdb::set<idx_t> *view_ids,
+    const duckdb::set<idx_t> *partition_table_ids) {
+  auto &base_data_path = transaction.GetCatalog().DataPath();
+  SnapshotParams params(snapshot);
+  duckdb::string query =
+      "SELECT * FROM ducklake._catalog_for_snapshot({SNAPSHOT_ID}";
+  if (table_ids) {
+    query += ", table_ids => " + params.AddBigintArray(*table_ids);
+  }
+  if (view_ids) {
+    query += ", view_ids => " + params.AddBigintArray(*view_ids);
+  }
+  if (partition_table_ids) {
+    query += ", partition_table_ids => " +
+             params.AddBigintArray(*partition_table_ids);
+  }
+  auto result = StreamQuery(snapshot, query + ")", &params);
   if (result->HasError()) {
     result->GetErrorObject().Throw(
-        "Failed to get table information from DuckLake: ");
+        "Failed to get catalog information from DuckLake: ");
   }
-  const idx_t COLUMN_INDEX_START = 8;
-  auto &tables = catalog.tables;
-  for (auto &row : *result) {
-    auto table_id = duckdb::TableIndex(row.GetValue<uint64_t>(1));
-
-    // check if this column belongs to the current table or not
-    if (tables.empty() || tables.back().id != table_id) {
-      // new table
-      duckdb::DuckLakeTableInfo table_info;
-      table_info.id = table_id;
-      table_info.schema_id = duckdb::SchemaIndex(row.GetValue<uint64_t>(0));
-      table_info.uuid = row.GetValue<duckdb::string>(2);
-      table_info.name = row.GetValue<duckdb::string>(3);
-      if (!row.IsNull(4)) {
-        auto tags = row.GetValue<duckdb::Value>(4);
-        table_info.tags = LoadTags(tags);
+  // Sections are appended after what `catalog` already holds, except for
+  // schemas, which are always all read
+  idx_t first_table = catalog.tables.size();
+  duckdb::map<duckdb::SchemaIndex, idx_t> schema_map;
+  duckdb::unordered_map<idx_t, idx_t> table_map;
+  duckdb::vector<ColumnTreeBuilder> table_columns;
+  while (auto chunk = result->Fetch()) {
+    auto row = GetChunkColumns(*chunk);
+    for (idx_t r = 0; r < chunk->size(); r++) {
+      auto id = row[CATALOG_ID].GetId(r);
+      switch (row[CATALOG_SECTION].GetId(r)) {
+      case SECTION_SCHEMA: {
+        duckdb::DuckLakeSchemaInfo schema;
+        schema.id = duckdb::SchemaIndex(id);
+        schema.uuid = row[CATALOG_UUID].GetString(r);
+        schema.name = row[CATALOG_NAME].GetString(r);
+        if (row[CATALOG_PATH].IsNull(r)) {
+          schema.path = base_data_path;
+        } else {
+          duckdb::DuckLakePath path;
+          path.path = row[CATALOG_PATH].GetString(r);
+          path.path_is_relative = row[CATALOG_PATH_IS_RELATIVE].GetBool(r);
+          schema.path = FromRelativePath(path);
+        }
+        schema_map[schema.id] = catalog.schemas.size();
+        catalog.schemas.push_back(std::move(schema));
+        break;
       }
-      if (!row.IsNull(5)) {
-        auto inlined_data_tables = row.GetValue<duckdb::Value>(5);
-        table_info.inlined_data_tables =
-            LoadInlinedDataTables(inlined_data_tables);
+      case SECTION_TABLE: {
+        duckdb::DuckLakeTableInfo table_info;
+        table_info.id = duckdb::TableIndex(id);
+        table_info.schema_id =
+            duckdb::SchemaIndex(row[CATALOG_PARENT_ID].GetId(r));
+        table_info.uuid = row[CATALOG_UUID].GetString(r);
+        table_info.name = row[CATALOG_NAME].GetString(r);
+        if (!row[CATALOG_TAGS].IsNull(r)) {
+          table_info.tags = LoadTags(row[CATALOG_TAGS].GetValue(r));
+        }
+        if (!row[CATALOG_INLINED_DATA_TABLES].IsNull(r)) {
+          table_info.inlined_data_tables = LoadInlinedDataTables(
+              row[CATALOG_INLINED_DATA_TABLES].GetValue(r));
+        }
+        auto schema_entry = schema_map.find(table_info.schema_id);
+        if (schema_entry == schema_map.end()) {
+          throw duckdb::InvalidInputException(
+              "Failed to load DuckLake - table with id %d references schema "
+              "id %d that does not exist",
+              table_info.id.index, table_info.schema_id.index);
+        }
+        auto &schema = catalog.schemas[schema_entry->second];
+        if (row[CATALOG_PATH].IsNull(r)) {
+          table_info.path = schema.path;
+        } else {
+          duckdb::DuckLakePath path;
+          path.path = row[CATALOG_PATH].GetString(r);
+          path.path_is_relative = row[CATALOG_PATH_IS_RELATIVE].GetBool(r);
+          table_info.path = FromRelativePath(path, schema.path);
+        }
+        table_map[id] = table_columns.size();
+        table_columns.emplace_back();
+        catalog.tables.push_back(std::move(table_info));
+        break;
       }
-      // find the schema
-      auto schema_entry = schema_map.find(table_info.schema_id);
-      if (schema_entry == schema_map.end()) {
-        throw duckdb::InvalidInputException(
-            "Failed to load DuckLake - table with id %d references schema id "
-            "%d that does not exist",
-            table_info.id.index, table_info.schema_id.index);
+      case SECTION_COLUMN: {
+        auto table_entry = table_map.find(row[CATALOG_PARENT_ID].GetId(r));
+        if (table_entry == table_map.end()) {
+          continue;
+        }
+        duckdb::DuckLakeColumnInfo column_info;
+        column_info.id = duckdb::FieldIndex(id);
+        column_info.name = row[CATALOG_NAME].GetString(r);
+        column_info.type = row[CATALOG_COLUMN_TYPE].GetString(r);
+        if (!row[CATALOG_INITIAL_DEFAULT].IsNull(r)) {
+          column_info.initial_default =
+              duckdb::Value(row[CATALOG_INITIAL_DEFAULT].GetString(r));
+        }
+        if (!row[CATALOG_DEFAULT_VALUE].IsNull(r)) {
+          column_info.default_value =
+              duckdb::Value(row[CATALOG_DEFAULT_VALUE].GetString(r));
+        }
+        column_info.nulls_allowed = row[CATALOG_NULLS_ALLOWED].GetBool(r);
+        if (!row[CATALOG_TAGS].IsNull(r)) {
+          column_info.tags = LoadTags(row[CATALOG_TAGS].GetValue(r));
+        }
+        duckdb::optional_idx parent_id;
+        if (!row[CATALOG_PARENT_COLUMN].IsNull(r)) {
+          parent_id =
+              duckdb::optional_idx(row[CATALOG_PARENT_COLUMN].GetId(r));
+        }
+        table_columns[table_entry->second].AddColumn(std::move(column_info),
+                                                     parent_id);
+        break;
       }
-      auto &schema = catalog.schemas[schema_entry->second];
-      if (row.IsNull(6)) {
-        // no path provided - fallback to schema path
-        table_info.path = schema.path;
-      } else {
-        // path is provided - load it
-        duckdb::DuckLakePath path;
-        path.path = row.GetValue<duckdb::string>(6);
-        path.path_is_relative = row.GetValue<bool>(7);
-
-        table_info.path = FromRelativePath(path, schema.path);
+      case SECTION_VIEW: {
+        duckdb::DuckLakeViewInfo view_info;
+        view_info.id = duckdb::TableIndex(id);
+        view_info.uuid = row[CATALOG_UUID].GetString(r);
+        view_info.schema_id =
+            duckdb::SchemaIndex(row[CATALOG_PARENT_ID].GetId(r));
+        view_info.name = row[CATALOG_NAME].GetString(r);
+        view_info.dialect = row[CATALOG_DIALECT].GetString(r);
+        view_info.sql = row[CATALOG_SQL].GetString(r);
+        view_info.column_aliases = duckdb::DuckLakeUtil::ParseQuotedList(
+            row[CATALOG_COLUMN_ALIASES].GetString(r));
+        if (!row[CATALOG_TAGS].IsNull(r)) {
+          view_info.tags = LoadTags(row[CATALOG_TAGS].GetValue(r));
+        }
+        catalog.views.push_back(std::move(view_info));
+        break;
+      }
+      case SECTION_PARTITION: {
+        auto table_id = duckdb::TableIndex(row[CATALOG_PARENT_ID].GetId(r));
+        auto &partitions = catalog.partitions;
+        if (partitions.empty() || partitions.back().table_id != table_id) {
+          duckdb::DuckLakePartitionInfo partition_info;
+          partition_info.id = id;
+          partition_info.table_id = table_id;
+          partitions.push_back(std::move(partition_info));
+        }
+        duckdb::DuckLakePartitionFieldInfo partition_field;
+        partition_field.partition_key_index =
+            row[CATALOG_PARTITION_KEY_INDEX].GetId(r);
+        partition_field.field_id =
+            duckdb::FieldIndex(row[CATALOG_FIELD_ID].GetId(r));
+        partition_field.transform = row[CATALOG_TRANSFORM].GetString(r);
+        partitions.back().fields.push_back(std::move(partition_field));
+        break;
+      }
+      default:
+        throw duckdb::InvalidInputException(
+            "Failed to load DuckLake - unknown catalog section");
       }
-      tables.push_back(std::move(table_info));
     }
-    auto &table_entry = tables.back();
-    if (row.GetValue<duckdb::Value>(COLUMN_INDEX_START).IsNull()) {
+  }
+
+  for (idx_t i = 0; i < table_columns.size(); i++) {
+    auto &table = catalog.tables[first_table + i];
+    if (table_columns[i].IsEmpty()) {
       throw duckdb::InvalidInputException(
           "Failed to load DuckLake - Table entry \"%s\" does not have any "
           "columns",
-          table_entry.name);
-    }
-    duckdb::DuckLakeColumnInfo column_info;
-    column_info.id =
-        duckdb::FieldIndex(row.GetValue<uint64_t>(COLUMN_INDEX_START));
-    column_info.name = row.GetValue<duckdb::string>(COLUMN_INDEX_START + 1);
-    column_info.type = row.GetValue<duckdb::string>(COLUMN_INDEX_START + 2);
-    if (!row.IsNull(COLUMN_INDEX_START + 3)) {
-      column_info.initial_default =
-          duckdb::Value(row.GetValue<duckdb::string>(COLUMN_INDEX_START + 3));
-    }
-    if (!row.IsNull(COLUMN_INDEX_START + 4)) {
-      column_info.default_value =
-          duckdb::Value(row.GetValue<duckdb::string>(COLUMN_INDEX_START + 4));
-    }
-    column_info.nulls_allowed = row.GetValue<bool>(COLUMN_INDEX_START + 5);
-    if (!row.IsNull(COLUMN_INDEX_START + 7)) {
-      auto tags = row.GetValue<duckdb::Value>(COLUMN_INDEX_START + 7);
-      column_info.tags = LoadTags(tags);
-    }
-
-    if (row.IsNull(COLUMN_INDEX_START + 6)) {
-      // base column - add the column to this table
-      table_entry.columns.push_back(std::move(column_info));
-    } else {
-      auto parent_id =
-          duckdb::FieldIndex(row.GetValue<idx_t>(COLUMN_INDEX_START + 6));
-      if (!AddChildColumn(table_entry.columns, parent_id, column_info)) {
-        throw duckdb::InvalidInputException(
-            "Failed to load DuckLake - Could not find parent column for column "
-            "%s",
-            column_info.name);
-      }
+          table.name);
     }
+    table.columns = table_columns[i].Build();
   }
-  // load view information
-  result = Query(snapshot, R"(
-SELECT view_id, view_uuid, schema_id, view_name, dialect, sql, column_aliases,
-	(
-		SELECT ARRAY_AGG(JSONB_BUILD_OBJECT('key', key, 'value', value))
-		FROM {METADATA_CATALOG}.ducklake_tag tag
-		WHERE object_id=view_id AND
-		      {SNAPSHOT_ID} >= tag.begin_snapshot AND ({SNAPSHOT_ID} < tag.end_snapshot OR tag.end_snapshot IS NULL)
-	) AS tag
-FROM {METADATA_CATALOG}.ducklake_view view
-WHERE {SNAPSHOT_ID} >= begin_snapshot AND ({SNAPSHOT_ID} < view.end_snapshot OR view.end_snapshot IS NULL)
-)");
+}
+
+/*
+ * The objects with a metadata row created or ended by a snapshot in
+ * (from_snapshot_id, to_snapshot_id], i.e. those that differ between the two
+ * snapshots, found through the begin_snapshot and end_snapshot indexes. The
+ * bounds are the parameters `from` and `to`.
+ */
+static duckdb::string CatalogChangesQuery(const duckdb::string &from,
+                                          const duckdb::string &to) {
+  auto query = duckdb::StringUtil::Replace(R"(
+SELECT 0, schema_id FROM {METADATA_CATALOG}.ducklake_schema WHERE {CHANGED}
+UNION ALL
+SELECT 1, table_id FROM {METADATA_CATALOG}.ducklake_table WHERE {CHANGED}
+UNION ALL
+SELECT 1, table_id FROM {METADATA_CATALOG}.ducklake_column WHERE {CHANGED}
+UNION ALL
+SELECT 1, table_id FROM {METADATA_CATALOG}.ducklake_column_tag WHERE {CHANGED}
+UNION ALL
+SELECT 2, object_id FROM {METADATA_CATALOG}.ducklake_tag WHERE {CHANGED}
+UNION ALL
+SELECT 3, view_id FROM {METADATA_CATALOG}.ducklake_view WHERE {CHANGED}
+UNION ALL
+SELECT 4, table_id FROM {METADATA_CATALOG}.ducklake_partition_info WHERE {CHANGED}
+)",
+                                           "{CHANGED}", R"((
+	(begin_snapshot > {FROM_SNAPSHOT_ID} AND begin_snapshot <= {TO_SNAPSHOT_ID}) OR
+	(end_snapshot > {FROM_SNAPSHOT_ID} AND end_snapshot <= {TO_SNAPSHOT_ID})
+))");
+  query = duckdb::StringUtil::Replace(query, "{FROM_SNAPSHOT_ID}", from);
+  return duckdb::StringUtil::Replace(query, "{TO_SNAPSHOT_ID}", to);
+}
+
+void PgDuckLakeMetadataManager::LoadCatalogChanges(
+    duckdb::DuckLakeSnapshot snapshot, idx_t from_snapshot_id,
+    idx_t to_snapshot_id, CatalogChanges &changes) {
+  SnapshotParams params(snapshot);
+  auto from = params.AddBigint(static_cast<int64>(from_snapshot_id));
+  auto to = params.AddBigint(static_cast<int64>(to_snapshot_id));
+  auto query = CatalogChangesQuery(from, to);
+  auto result = StreamQuery(snapshot, query, &params);
   if (result->HasError()) {
     result->GetErrorObject().Throw(
-        "Failed to get partition information from DuckLake: ");
+        "Failed to get catalog changes from DuckLake: ");
   }
-  auto &views = catalog.views;
   for (auto &row : *result) {
-    duckdb::DuckLakeViewInfo view_info;
-    view_info.id = duckdb::TableIndex(row.GetValue<uint64_t>(0));
-    view_info.uuid = row.GetValue<duckdb::string>(1);
-    view_info.schema_id = duckdb::SchemaIndex(row.GetValue<uint64_t>(2));
-    view_info.name = row.GetValue<duckdb::string>(3);
-    view_info.dialect = row.GetValue<duckdb::string>(4);
-    view_info.sql = row.GetValue<duckdb::string>(5);
-    view_info.column_aliases =
-        duckdb::DuckLakeUtil::ParseQuotedList(row.GetValue<duckdb::string>(6));
-    if (!row.IsNull(7)) {
-      auto tags = row.GetValue<duckdb::Value>(7);
-      view_info.tags = LoadTags(tags);
-    }
-    views.push_back(std::move(view_info));
-  }
-
-  // load partition information
-  result = Query(snapshot, R"(
-SELECT partition_id, part.table_id, partition_key_index, column_id, transform
-FROM {METADATA_CATALOG}.ducklake_partition_info part
-JOIN {METADATA_CATALOG}.ducklake_partition_column part_col USING (partition_id)
-WHERE {SNAPSHOT_ID} >= part.begin_snapshot AND ({SNAPSHOT_ID} < part.end_snapshot OR part.end_snapshot IS NULL)
-ORDER BY part.table_id, partition_id, partition_key_index
+    auto id = row.GetValue<uint64_t>(1);
+    switch (row.GetValue<int32_t>(0)) {
+    case 0:
+      changes.schema_ids.insert(id);
+      break;
+    case 1:
+      changes.table_ids.insert(id);
+      break;
+    case 2:
+      // tags of a table or a view; ids are unique across both
+      changes.table_ids.insert(id);
+      changes.view_ids.insert(id);
+      break;
+    case 3:
+      changes.view_ids.insert(id);
+      break;
+    default:
+      changes.partition_table_ids.insert(id);
+      break;
+    }
+  }
+}
+
+/*
+ * Turn the catalog of `base_snapshot_id` into that of `snapshot` by reloading
+ * only what changed in between. A new snapshot usually touches a table or
+ * two, so this is much cheaper than reading the whole catalog again.
+ *
+ * Schemas are few and reloaded in full, with the changed objects in one
+ * catalog query. Inlined data tables carry no snapshot
+ * range and are refreshed for all tables from their own, narrow table.
+ *
+ * Such a table is listed for every snapshot whose schema version is at least
+ * the one it was created for. That makes the list a function of the
+ * snapshot, so it can be cached with the catalog: a snapshot of that schema
+ * version taken before the table was created finds no rows in it that are
+ * visible, the same as if it were not listed. A row is only removed together
+ * with the table it names, and a catalog cached before that is no different
+ * from one DuckLake itself loaded before it.
+ */
+void PgDuckLakeMetadataManager::RefreshCatalog(
+    idx_t base_snapshot_id, duckdb::DuckLakeSnapshot snapshot,
+    duckdb::DuckLakeCatalogInfo &catalog) {
+  CatalogChanges changes;
+  LoadCatalogChanges(snapshot, base_snapshot_id, snapshot.snapshot_id,
+                     changes);
+  auto &schema_ids = changes.schema_ids;
+  auto &table_ids = changes.table_ids;
+  auto &view_ids = changes.view_ids;
+  auto &partition_table_ids = changes.partition_table_ids;
+
+  // The paths of tables derive from the path of their schema
+  for (auto &table : catalog.tables) {
+    if (schema_ids.count(table.schema_id.index)) {
+      table_ids.insert(table.id.index);
+    }
+  }
+
+  catalog.schemas.clear();
+  duckdb::vector<duckdb::DuckLakeTableInfo> tables;
+  for (auto &table : catalog.tables) {
+    if (!table_ids.count(table.id.index)) {
+      tables.push_back(std::move(table));
+    }
+  }
+  catalog.tables = std::move(tables);
+  idx_t kept_tables = catalog.tables.size();
+
+  duckdb::vector<duckdb::DuckLakeViewInfo> views;
+  for (auto &view : catalog.views) {
+    if (!view_ids.count(view.id.index)) {
+      views.push_back(std::move(view));
+    }
+  }
+  catalog.views = std::move(views);
+
+  duckdb::vector<duckdb::DuckLakePartitionInfo> partitions;
+  for (auto &partition : catalog.partitions) {
+    if (!partition_table_ids.count(partition.table_id.index)) {
+      partitions.push_back(std::move(partition));
+    }
+  }
+  catalog.partitions = std::move(partitions);
+
+  LoadCatalog(snapshot, catalog, &table_ids, &view_ids, &partition_table_ids);
+  std::sort(catalog.tables.begin(), catalog.tables.end(),
+            [](const duckdb::DuckLakeTableInfo &a,
+               const duckdb::DuckLakeTableInfo &b) {
+              return a.id.index < b.id.index;
+            });
+  std::stable_sort(catalog.partitions.begin(), catalog.partitions.end(),
+                   [](const duckdb::DuckLakePartitionInfo &a,
+                      const duckdb::DuckLakePartitionInfo &b) {
+                     return a.table_id.index < b.table_id.index;
+                   });
+
+  if (kept_tables > 0) {
+    RefreshInlinedDataTables(snapshot, catalog);
+  }
+}
+
+void PgDuckLakeMetadataManager::RefreshInlinedDataTables(
+    duckdb::DuckLakeSnapshot snapshot, duckdb::DuckLakeCatalogInfo &catalog) {
+  auto result = StreamQuery(snapshot, R"(
+SELECT table_id, array_agg(ROW(table_name, schema_version)::ducklake._inlined_table)
+FROM {METADATA_CATALOG}.ducklake_inlined_data_tables
+WHERE schema_version <= {SCHEMA_VERSION}
+GROUP BY table_id
 )");
   if (result->HasError()) {
     result->GetErrorObject().Throw(
-        "Failed to get partition information from DuckLake: ");
+        "Failed to get inlined data tables from DuckLake: ");
   }
-  auto &partitions = catalog.partitions;
+  duckdb::unordered_map<idx_t, duckdb::vector<duckdb::DuckLakeInlinedTableInfo>>
+      inlined_data_tables;
   for (auto &row : *result) {
-    auto partition_id = row.GetValue<uint64_t>(0);
-    auto table_id = duckdb::TableIndex(row.GetValue<uint64_t>(1));
-
-    if (partitions.empty() || partitions.back().table_id != table_id) {
-      duckdb::DuckLakePartitionInfo partition_info;
-      partition_info.id = partition_id;
-      partition_info.table_id = table_id;
-      partitions.push_back(std::move(partition_info));
+    inlined_data_tables[row.GetValue<uint64_t>(0)] =
+        LoadInlinedDataTables(row.GetValue<duckdb::Value>(1));
+  }
+  for (auto &table : catalog.tables) {
+    auto entry = inlined_data_tables.find(table.id.index);
+    if (entry == inlined_data_tables.end()) {
+      table.inlined_data_tables.clear();
+    } else {
+      table.inlined_data_tables = std::move(entry->second);
     }
-    auto &partition_entry = partitions.back();
+  }
+}
 
-    duckdb::DuckLakePartitionFieldInfo partition_field;
-    partition_field.partition_key_index = row.GetValue<uint64_t>(2);
-    partition_field.field_id = duckdb::FieldIndex(row.GetValue<uint64_t>(3));
-    partition_field.transform = row.GetValue<duckdb::string>(4);
-    partition_entry.fields.push_back(std::move(partition_field));
+// The composite types of the extension script, by their field names
+static const char *ListRowType(
+    const duckdb::vector<std::pair<duckdb::string, duckdb::string>> &fields,
+    duckdb::vector<duckdb::string> &field_names) {
+  static const struct {
+    const char *type;
+    duckdb::vector<duckdb::string> fields;
+  } row_types[] = {{"ducklake._tag", {"key", "value"}},
+                   {"ducklake._inlined_table", {"name", "schema_version"}}};
+  for (auto &row_type : row_types) {
+    if (fields.size() != row_type.fields.size()) {
+      continue;
+    }
+    bool matches = true;
+    for (auto &entry : fields) {
+      matches = matches && std::find(row_type.fields.begin(),
+                                     row_type.fields.end(),
+                                     entry.first) != row_type.fields.end();
+    }
+    if (matches) {
+      field_names = row_type.fields;
+      return row_type.type;
+    }
   }
-  return catalog;
+  return nullptr;
 }
 
 duckdb::string PgDuckLakeMetadataManager::WrapWithListAggregation(
     const duckdb::vector<std::pair<duckdb::string, duckdb::string>> &fields)
     const {
+  // Lists of tags and inlined tables are arrays of a composite type, which the
+  // bridge turns into LIST<STRUCT>; any other list stays JSON.
+  duckdb::vector<duckdb::string> field_names;
+  auto row_type = ListRowType(fields, field_names);
   duckdb::string fields_part;
+  if (row_type) {
+    for (auto &name : field_names) {
+      for (auto const &entry : fields) {
+        if (entry.first == name) {
+          fields_part += (fields_part.empty() ? "" : ", ") + entry.second;
+        }
+      }
+    }
+    return "array_agg(ROW(" + fields_part + ")::" + row_type + ")";
+  }
   for (auto const &entry : fields) {
     if (!fields_part.empty()) {
       fields_part += ", ";
@@ -574,4 +1130,97 @@ duckdb::string PgDuckLakeMetadataManager::WrapWithListAggregation(
   return "json_agg(json_build_object(" + fields_part + "))";
 }
 
+// Add the row (`name`, `query` with its snapshot placeholders bound as $1 to
+// $4) to `tupstore`
+static void PutReadQuery(Tuplestorestate *tupstore, TupleDesc tupdesc,
+                         const char *name, duckdb::string query) {
+  ParameterizeSnapshotArgs(query);
+  Datum values[2];
+  bool nulls[2] = {false, false};
+  values[0] = CStringGetTextDatum(name);
+  values[1] = CStringGetTextDatum(query.c_str());
+  tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+}
+
 } // namespace pgducklake
+
+extern "C" {
+
+/*
+ * ducklake_catalog_loads() - How many catalogs this backend patched from a
+ * cached one and how many it read in full, for tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_catalog_loads) {
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+  Datum values[2];
+  bool nulls[2] = {false, false};
+  values[0] = Int64GetDatum(pgducklake::catalog_refreshes);
+  values[1] = Int64GetDatum(pgducklake::catalog_full_loads);
+  PG_RETURN_DATUM(
+      HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+/*
+ * ducklake_metadata_read_queries() - The text of the reads the metadata
+ * manager plans, as it binds them: the catalog change set, and every cached
+ * file list at the latest snapshot and at older ones. For tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_metadata_read_queries) {
+  auto *rsinfo = reinterpret_cast<ReturnSetInfo *>(fcinfo->resultinfo);
+  if (!rsinfo || !IsA(rsinfo, ReturnSetInfo) ||
+      !(rsinfo->allowedModes & SFRM_Materialize)) {
+    elog(ERROR, "materialize mode required, but it is not allowed in this "
+                "context");
+  }
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+
+  MemoryContext old_context =
+      MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+  Tuplestorestate *tupstore = tuplestore_begin_heap(true, false, work_mem);
+  rsinfo->returnMode = SFRM_Materialize;
+  rsinfo->setResult = tupstore;
+  rsinfo->setDesc = CreateTupleDescCopy(tupdesc);
+  MemoryContextSwitchTo(old_context);
+
+  // The bounds are the first values bound after the snapshot
+  pgducklake::PutReadQuery(
+      tupstore, rsinfo->setDesc, "catalog_changes",
+      duckdb::StringUtil::Replace(pgducklake::CatalogChangesQuery("$5", "$6"),
+                                  "{METADATA_CATALOG}", "ducklake"));
+  for (auto &query : pgducklake::FileListCache::GetQueries()) {
+    auto latest = pgducklake::RewriteVisibleAtSnapshot(query);
+    if (!latest.empty()) {
+      pgducklake::PutReadQuery(tupstore, rsinfo->setDesc, "file_list_latest",
+                               latest);
+    }
+    pgducklake::PutReadQuery(tupstore, rsinfo->setDesc, "file_list", query);
+  }
+  return (Datum)0;
+}
+
+/*
+ * ducklake_file_list_loads() - How many file lists this backend took from its
+ * cache as they were, patched with the files that changed, and read in full,
+ * for tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_file_list_loads) {
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+  Datum values[3];
+  bool nulls[3] = {false, false, false};
+  values[0] = Int64GetDatum(pgducklake::file_list_hits);
+  values[1] = Int64GetDatum(pgducklake::file_list_refreshes);
+  values[2] = Int64GetDatum(pgducklake::file_list_full_reads);
+  PG_RETURN_DATUM(
+      HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+} // extern "C"
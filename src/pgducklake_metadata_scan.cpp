@@ -0,0 +1,529 @@
+#include "pgducklake/pgducklake_metadata_scan.hpp"
+
+#include "pgducklake/pgducklake_pg_types.hpp"
+#include "pgducklake/pgducklake_spi.hpp"
+
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/main/materialized_query_result.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/htup_details.h"
+#include "access/skey.h"
+#include "access/table.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_index.h"
+#include "catalog/pg_opfamily.h"
+#include "catalog/pg_type.h"
+#include "miscadmin.h"
+#include "utils/acl.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+}
+
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include <cctype>
+
+namespace pgducklake {
+
+static Oid GetMetadataRelid(const char *relname) {
+  Oid nspoid = get_namespace_oid("ducklake", true);
+  if (!OidIsValid(nspoid)) {
+    return InvalidOid;
+  }
+  return get_relname_relid(relname, nspoid);
+}
+
+// Whether key `key` of btree index `index` sorts with the default bigint
+// operators, which our scan keys (F_INT8EQ, F_INT8GT) assume.
+static bool IsInt8Key(Relation index, int key) {
+  return index->rd_opfamily[key] == INTEGER_BTREE_FAM_OID &&
+         index->rd_opcintype[key] == INT8OID;
+}
+
+// A valid, non-partial btree index of `rel` whose first key is `attnum`, and
+// whose second key is `next_attnum` if that is given, both with the bigint
+// operator class.
+static Oid FindIndexOn(Relation rel, AttrNumber attnum,
+                       AttrNumber next_attnum = InvalidAttrNumber) {
+  Oid result = InvalidOid;
+  List *indexes = RelationGetIndexList(rel);
+  ListCell *lc;
+  foreach (lc, indexes) {
+    Relation index = index_open(lfirst_oid(lc), AccessShareLock);
+    Form_pg_index form = index->rd_index;
+    bool usable =
+        form->indisvalid && index->rd_rel->relam == BTREE_AM_OID &&
+        form->indkey.values[0] == attnum && IsInt8Key(index, 0) &&
+        (next_attnum == InvalidAttrNumber ||
+         (form->indnkeyatts > 1 && form->indkey.values[1] == next_attnum &&
+          IsInt8Key(index, 1))) &&
+        heap_attisnull(index->rd_indextuple, Anum_pg_index_indpred, nullptr);
+    index_close(index, AccessShareLock);
+    if (usable) {
+      result = lfirst_oid(lc);
+      break;
+    }
+  }
+  list_free(indexes);
+  return result;
+}
+
+/*
+ * MetadataScan - scan of a metadata table, either for one value of a bigint
+ * column and values of a second one above a bound, or in descending order of
+ * a bigint column, through an index on those columns when there is one.
+ */
+class MetadataScan {
+public:
+  explicit MetadataScan(const char *relname) {
+    Oid relid = GetMetadataRelid(relname);
+    if (OidIsValid(relid)) {
+      rel = table_open(relid, AccessShareLock);
+    }
+  }
+
+  ~MetadataScan() {
+    if (scan) {
+      systable_endscan(scan);
+    }
+    if (ordered_scan) {
+      systable_endscan_ordered(ordered_scan);
+    }
+    if (rel) {
+      table_close(rel, AccessShareLock);
+    }
+  }
+
+  bool IsValid() const { return rel != nullptr; }
+
+  // The column `name`, InvalidAttrNumber if there is none
+  AttrNumber FindColumn(const char *name) const {
+    return get_attnum(RelationGetRelid(rel), name);
+  }
+
+  AttrNumber Column(const char *name) const {
+    AttrNumber attnum = FindColumn(name);
+    if (attnum == InvalidAttrNumber) {
+      elog(ERROR, "DuckLake metadata table \"%s\" has no column \"%s\"",
+           RelationGetRelationName(rel), name);
+    }
+    return attnum;
+  }
+
+  // A bigint column to scan by; the scan keys compare with int8 operators
+  AttrNumber KeyColumn(const char *name) const {
+    AttrNumber attnum = Column(name);
+    if (TupleDescAttr(RelationGetDescr(rel), attnum - 1)->atttypid !=
+        INT8OID) {
+      elog(ERROR, "DuckLake metadata column \"%s\".\"%s\" is not a bigint",
+           RelationGetRelationName(rel), name);
+    }
+    return attnum;
+  }
+
+  // Rows where `column` equals `value` and `after_column` is above `after`
+  void BeginEqualsAfter(Snapshot snapshot, const char *column, int64 value,
+                        const char *after_column, int64 after) {
+    AttrNumber attnum = KeyColumn(column);
+    AttrNumber after_attnum = KeyColumn(after_column);
+    Oid index = FindIndexOn(rel, attnum, after_attnum);
+    ScanKeyInit(&keys[0], attnum, BTEqualStrategyNumber, F_INT8EQ,
+                Int64GetDatum(value));
+    ScanKeyInit(&keys[1], after_attnum, BTGreaterStrategyNumber, F_INT8GT,
+                Int64GetDatum(after));
+    scan = systable_beginscan(rel, index, OidIsValid(index), snapshot, 2, keys);
+  }
+
+  // Rows where bigint column `attnum` equals `value`, through an index on it.
+  // False, with nothing started, if there is no such index.
+  bool BeginEquals(Snapshot snapshot, AttrNumber attnum, int64 value) {
+    Oid index = FindIndexOn(rel, attnum);
+    if (!OidIsValid(index)) {
+      return false;
+    }
+    ScanKeyInit(&keys[0], attnum, BTEqualStrategyNumber, F_INT8EQ,
+                Int64GetDatum(value));
+    scan = systable_beginscan(rel, index, true, snapshot, 1, keys);
+    return true;
+  }
+
+  // Whether the current user may read every row of the table as is
+  bool CanRead() const {
+    return pg_class_aclcheck(RelationGetRelid(rel), GetUserId(),
+                             ACL_SELECT) == ACLCHECK_OK &&
+           !rel->rd_rel->relrowsecurity;
+  }
+
+  TupleDesc GetDescriptor() const { return RelationGetDescr(rel); }
+
+  // Scan in descending `column` order if it is indexed, in any order
+  // otherwise.
+  void BeginDescending(Snapshot snapshot, const char *column) {
+    Oid index = FindIndexOn(rel, Column(column));
+    if (OidIsValid(index)) {
+      Relation index_rel = index_open(index, AccessShareLock);
+      ordered_scan =
+          systable_beginscan_ordered(rel, index_rel, snapshot, 0, nullptr);
+      // The scan keeps its own reference to the index
+      index_close(index_rel, NoLock);
+    } else {
+      scan = systable_beginscan(rel, InvalidOid, false, snapshot, 0, nullptr);
+    }
+  }
+
+  bool IsOrdered() const { return ordered_scan != nullptr; }
+
+  HeapTuple Next() {
+    if (ordered_scan) {
+      return systable_getnext_ordered(ordered_scan, BackwardScanDirection);
+    }
+    return systable_getnext(scan);
+  }
+
+  // The value of bigint column `attnum`, like every id and snapshot column
+  int64 GetInt(HeapTuple tuple, AttrNumber attnum, bool *isnull) const {
+    if (TupleDescAttr(RelationGetDescr(rel), attnum - 1)->atttypid !=
+        INT8OID) {
+      elog(ERROR, "DuckLake metadata column %s.%d is not a bigint",
+           RelationGetRelationName(rel), attnum);
+    }
+    Datum value = heap_getattr(tuple, attnum, RelationGetDescr(rel), isnull);
+    return *isnull ? 0 : DatumGetInt64(value);
+  }
+
+  int64 GetInt(HeapTuple tuple, AttrNumber attnum) const {
+    bool isnull;
+    return GetInt(tuple, attnum, &isnull);
+  }
+
+private:
+  Relation rel = nullptr;
+  ScanKeyData keys[2];
+  SysScanDesc scan = nullptr;
+  SysScanDesc ordered_scan = nullptr;
+};
+
+static duckdb::DuckLakeSnapshot ReadSnapshot(MetadataScan &scan,
+                                             HeapTuple tuple) {
+  return duckdb::DuckLakeSnapshot(
+      scan.GetInt(tuple, scan.Column("snapshot_id")),
+      scan.GetInt(tuple, scan.Column("schema_version")),
+      scan.GetInt(tuple, scan.Column("next_catalog_id")),
+      scan.GetInt(tuple, scan.Column("next_file_id")));
+}
+
+static bool ScanLatest(Snapshot pg_snapshot, duckdb::DuckLakeSnapshot &snapshot,
+                       TransactionId *xmin) {
+  MetadataScan scan("ducklake_snapshot");
+  if (!scan.IsValid()) {
+    return false;
+  }
+  bool found = false;
+  scan.BeginDescending(pg_snapshot, "snapshot_id");
+  AttrNumber id_attnum = scan.Column("snapshot_id");
+  int64 max_id = -1;
+  HeapTuple tuple;
+  while (HeapTupleIsValid(tuple = scan.Next())) {
+    int64 id = scan.GetInt(tuple, id_attnum);
+    if (id > max_id) {
+      max_id = id;
+      snapshot = ReadSnapshot(scan, tuple);
+      if (xmin) {
+        *xmin = HeapTupleHeaderGetXmin(tuple->t_data);
+      }
+      found = true;
+    }
+    if (scan.IsOrdered()) {
+      break;
+    }
+  }
+  return found;
+}
+
+bool ScanLatestSnapshot(duckdb::DuckLakeSnapshot &snapshot) {
+  PostgresScopedStackReset scoped_stack_reset;
+  PushMetadataReadSnapshot();
+  bool found = ScanLatest(GetActiveSnapshot(), snapshot, nullptr);
+  PopActiveSnapshot();
+  return found;
+}
+
+bool ScanLatestCommittedSnapshot(duckdb::DuckLakeSnapshot &snapshot,
+                                 TransactionId &xmin) {
+  PostgresScopedStackReset scoped_stack_reset;
+  Snapshot latest = RegisterSnapshot(GetLatestSnapshot());
+  bool found = ScanLatest(latest, snapshot, &xmin);
+  UnregisterSnapshot(latest);
+  return found;
+}
+
+// Add the data_file_id of the rows of `relname` for table `table_id` that
+// began or ended in (from_snapshot, to_snapshot] to `data_file_ids`. Either
+// bound is looked up through the (table_id, begin_snapshot) and (table_id,
+// end_snapshot) indexes.
+static bool CollectChangedFiles(const char *relname, idx_t table_id,
+                                idx_t from_snapshot, idx_t to_snapshot,
+                                duckdb::set<idx_t> &data_file_ids) {
+  for (auto column : {"begin_snapshot", "end_snapshot"}) {
+    MetadataScan scan(relname);
+    if (!scan.IsValid()) {
+      return false;
+    }
+    scan.BeginEqualsAfter(GetActiveSnapshot(), "table_id",
+                          static_cast<int64>(table_id), column,
+                          static_cast<int64>(from_snapshot));
+    AttrNumber attnum = scan.Column(column);
+    AttrNumber file_attnum = scan.Column("data_file_id");
+    HeapTuple tuple;
+    while (HeapTupleIsValid(tuple = scan.Next())) {
+      if (static_cast<idx_t>(scan.GetInt(tuple, attnum)) <= to_snapshot) {
+        data_file_ids.insert(scan.GetInt(tuple, file_attnum));
+      }
+    }
+  }
+  return true;
+}
+
+bool ScanTableFilesChanged(idx_t table_id, idx_t from_snapshot,
+                           idx_t to_snapshot,
+                           duckdb::set<idx_t> &data_file_ids) {
+  PostgresScopedStackReset scoped_stack_reset;
+  PushMetadataReadSnapshot();
+  bool found = CollectChangedFiles("ducklake_data_file", table_id,
+                                   from_snapshot, to_snapshot,
+                                   data_file_ids) &&
+               CollectChangedFiles("ducklake_delete_file", table_id,
+                                   from_snapshot, to_snapshot, data_file_ids);
+  PopActiveSnapshot();
+  return found;
+}
+
+/*
+ * A point lookup "SELECT c1, c2, ... FROM <schema>.ducklake_x WHERE key = n",
+ * optionally restricted to the rows visible at the snapshot.
+ */
+struct PointLookup {
+  duckdb::vector<duckdb::string> columns;
+  duckdb::string relname;
+  duckdb::string key;
+  int64 value = 0;
+  bool at_snapshot = false;
+};
+
+static bool IsIdentifier(const duckdb::string &name) {
+  if (name.empty() || isdigit(static_cast<unsigned char>(name[0]))) {
+    return false;
+  }
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static duckdb::string Unquote(const duckdb::string &name) {
+  if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+    return name.substr(1, name.size() - 2);
+  }
+  return name;
+}
+
+// `query` with every run of white space turned into a single space, and
+// without the trailing semicolon.
+static duckdb::string NormalizeSpaces(const duckdb::string &query) {
+  duckdb::string result;
+  for (char c : query) {
+    if (!isspace(static_cast<unsigned char>(c))) {
+      result += c;
+    } else if (!result.empty() && result.back() != ' ') {
+      result += ' ';
+    }
+  }
+  while (!result.empty() && (result.back() == ' ' || result.back() == ';')) {
+    result.pop_back();
+  }
+  return result;
+}
+
+static bool ParsePointLookup(const duckdb::string &query,
+                             PointLookup &lookup) {
+  static const duckdb::string visible =
+      " AND {SNAPSHOT_ID} >= begin_snapshot AND ({SNAPSHOT_ID} < "
+      "end_snapshot OR end_snapshot IS NULL)";
+  auto text = NormalizeSpaces(query);
+  if (!duckdb::StringUtil::StartsWith(text, "SELECT ")) {
+    return false;
+  }
+  auto from = text.find(" FROM ");
+  auto where = text.find(" WHERE ");
+  if (from == duckdb::string::npos || where == duckdb::string::npos ||
+      where < from) {
+    return false;
+  }
+
+  // Plain columns only, no expressions or aliases
+  for (auto column :
+       duckdb::StringUtil::Split(text.substr(7, from - 7), ',')) {
+    duckdb::StringUtil::Trim(column);
+    if (!IsIdentifier(column)) {
+      return false;
+    }
+    lookup.columns.push_back(column);
+  }
+
+  // A metadata table, whatever the catalog in front of its schema
+  auto names =
+      duckdb::StringUtil::Split(text.substr(from + 6, where - from - 6), '.');
+  if (names.size() < 2 || Unquote(names[names.size() - 2]) != "ducklake") {
+    return false;
+  }
+  lookup.relname = Unquote(names.back());
+  if (!IsIdentifier(lookup.relname) ||
+      !duckdb::StringUtil::StartsWith(lookup.relname, "ducklake_")) {
+    return false;
+  }
+
+  auto condition = text.substr(where + 7);
+  if (duckdb::StringUtil::EndsWith(condition, visible)) {
+    lookup.at_snapshot = true;
+    condition.resize(condition.size() - visible.size());
+  }
+  auto equals = condition.find(" = ");
+  if (equals == duckdb::string::npos) {
+    return false;
+  }
+  lookup.key = condition.substr(0, equals);
+  auto value = condition.substr(equals + 3);
+  // Ids are never negative, and 18 digits cannot overflow
+  if (!IsIdentifier(lookup.key) || value.empty() || value.size() > 18 ||
+      value.find_first_not_of("0123456789") != duckdb::string::npos) {
+    return false;
+  }
+  lookup.value = std::stoll(value);
+  return true;
+}
+
+// Convert `tuples` into `chunk`, append it to `collection` and free them
+static void
+AppendTuples(duckdb::ColumnDataCollection &collection, duckdb::DataChunk &chunk,
+             const duckdb::vector<PostgresColumnConverter> &converters,
+             const duckdb::vector<AttrNumber> &attnums, TupleDesc tupdesc,
+             duckdb::vector<HeapTuple> &tuples) {
+  idx_t count = tuples.size();
+  if (count == 0) {
+    return;
+  }
+  chunk.Reset();
+  Datum *values = static_cast<Datum *>(palloc(count * sizeof(Datum)));
+  bool *nulls = static_cast<bool *>(palloc(count * sizeof(bool)));
+  for (idx_t col = 0; col < attnums.size(); col++) {
+    for (idx_t row = 0; row < count; row++) {
+      values[row] =
+          heap_getattr(tuples[row], attnums[col], tupdesc, &nulls[row]);
+      if (nulls[row]) {
+        duckdb::FlatVector::Validity(chunk.data[col]).SetInvalid(row);
+      }
+    }
+    converters[col].Convert(values, nulls, count, chunk.data[col]);
+  }
+  chunk.SetCardinality(count);
+  collection.Append(chunk);
+  pfree(values);
+  pfree(nulls);
+  for (auto tuple : tuples) {
+    heap_freetuple(tuple);
+  }
+  tuples.clear();
+}
+
+static duckdb::unique_ptr<duckdb::QueryResult>
+RunPointLookup(const PointLookup &lookup, duckdb::optional_idx snapshot_id) {
+  MetadataScan scan(lookup.relname.c_str());
+  if (!scan.IsValid() || !scan.CanRead()) {
+    return nullptr;
+  }
+  TupleDesc tupdesc = scan.GetDescriptor();
+
+  duckdb::vector<AttrNumber> attnums;
+  duckdb::vector<PostgresColumnConverter> converters;
+  duckdb::vector<duckdb::LogicalType> types;
+  for (auto &column : lookup.columns) {
+    AttrNumber attnum = scan.FindColumn(column.c_str());
+    if (attnum == InvalidAttrNumber) {
+      return nullptr;
+    }
+    attnums.push_back(attnum);
+    converters.emplace_back(TupleDescAttr(tupdesc, attnum - 1));
+    types.push_back(converters.back().GetType());
+  }
+  AttrNumber begin_attnum = InvalidAttrNumber;
+  AttrNumber end_attnum = InvalidAttrNumber;
+  if (lookup.at_snapshot) {
+    begin_attnum = scan.FindColumn("begin_snapshot");
+    end_attnum = scan.FindColumn("end_snapshot");
+    if (begin_attnum == InvalidAttrNumber || end_attnum == InvalidAttrNumber) {
+      return nullptr;
+    }
+  }
+  AttrNumber key_attnum = scan.FindColumn(lookup.key.c_str());
+  if (key_attnum == InvalidAttrNumber ||
+      !scan.BeginEquals(GetActiveSnapshot(), key_attnum, lookup.value)) {
+    return nullptr;
+  }
+
+  auto &allocator = duckdb::Allocator::DefaultAllocator();
+  auto collection =
+      duckdb::make_uniq<duckdb::ColumnDataCollection>(allocator, types);
+  duckdb::DataChunk chunk;
+  chunk.Initialize(allocator, types);
+  duckdb::vector<HeapTuple> tuples;
+  HeapTuple tuple;
+  while (HeapTupleIsValid(tuple = scan.Next())) {
+    if (lookup.at_snapshot) {
+      auto id = static_cast<int64>(snapshot_id.GetIndex());
+      bool end_isnull;
+      int64 end = scan.GetInt(tuple, end_attnum, &end_isnull);
+      if (scan.GetInt(tuple, begin_attnum) > id ||
+          (!end_isnull && end <= id)) {
+        continue;
+      }
+    }
+    // The tuple is only valid until the next one is fetched
+    tuples.push_back(heap_copytuple(tuple));
+    if (tuples.size() == STANDARD_VECTOR_SIZE) {
+      AppendTuples(*collection, chunk, converters, attnums, tupdesc, tuples);
+    }
+  }
+  AppendTuples(*collection, chunk, converters, attnums, tupdesc, tuples);
+
+  duckdb::StatementProperties properties;
+  duckdb::ClientProperties client_properties;
+  return duckdb::make_uniq<duckdb::MaterializedQueryResult>(
+      duckdb::StatementType::SELECT_STATEMENT, properties, lookup.columns,
+      std::move(collection), client_properties);
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+ScanPointLookup(const duckdb::string &query, duckdb::optional_idx snapshot_id) {
+  PointLookup lookup;
+  if (!ParsePointLookup(query, lookup) ||
+      (lookup.at_snapshot && !snapshot_id.IsValid())) {
+    return nullptr;
+  }
+  PostgresScopedStackReset scoped_stack_reset;
+  PushMetadataReadSnapshot();
+  auto result = RunPointLookup(lookup, snapshot_id);
+  PopActiveSnapshot();
+  return result;
+}
+
+} // namespace pgducklake
@@ -5,23 +5,37 @@
 
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/datetime.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include "duckdb/common/types/interval.hpp"
 #include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/common/types/uuid.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <string>
+
 extern "C" {
 #include "postgres.h"
 #include "access/detoast.h"
+#include "access/htup_details.h"
 #include "access/table.h"
 #include "access/tableam.h"
+#include "catalog/pg_enum.h"
 #include "catalog/pg_type.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
+#include "utils/cash.h"
 #include "utils/date.h"
 #include "utils/expandeddatum.h"
 #include "utils/jsonb.h"
 #include "utils/lsyscache.h"
 #include "utils/numeric.h"
+#include "utils/pg_locale.h"
+#include "utils/syscache.h"
 #include "utils/timestamp.h"
+#include "utils/typcache.h"
 #include "utils/uuid.h"
 }
 
@@ -32,6 +46,464 @@ constexpr int32_t DUCK_DATE_OFFSET = 10957;
 constexpr int64_t DUCK_TIMESTAMP_OFFSET =
     static_cast<int64_t>(DUCK_DATE_OFFSET) * static_cast<int64_t>(86400000000);
 
+// DuckDB encodes +/-infinity as the largest magnitudes of the physical type,
+// PG as its minimum and maximum
+constexpr int32_t DUCK_DATE_INFINITY = std::numeric_limits<int32_t>::max();
+constexpr int64_t DUCK_TIMESTAMP_INFINITY = std::numeric_limits<int64_t>::max();
+
+// Clone the batch kernels for wider vector units, picked by the dynamic loader
+// for the CPU we run on
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define PGDUCKLAKE_TARGET_CLONES                                               \
+  __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#ifndef PGDUCKLAKE_TARGET_CLONES
+#define PGDUCKLAKE_TARGET_CLONES
+#endif
+
+static inline int32_t ConvertDate(int32_t pg_date) {
+  // PostgreSQL dates are days since 2000-01-01
+  // DuckDB dates are days since 1970-01-01
+  return pg_date == DATEVAL_NOEND     ? DUCK_DATE_INFINITY
+         : pg_date == DATEVAL_NOBEGIN ? -DUCK_DATE_INFINITY
+                                      : pg_date + DUCK_DATE_OFFSET;
+}
+
+static inline int64_t ConvertTimestamp(int64_t pg_ts) {
+  // PostgreSQL timestamps are microseconds since 2000-01-01
+  // DuckDB timestamps are microseconds since 1970-01-01
+  return pg_ts == DT_NOEND     ? DUCK_TIMESTAMP_INFINITY
+         : pg_ts == DT_NOBEGIN ? -DUCK_TIMESTAMP_INFINITY
+                               : pg_ts + DUCK_TIMESTAMP_OFFSET;
+}
+
+// PG stores UUIDs as 16 big-endian bytes, DuckDB as a hugeint with the top bit
+// flipped so that signed comparison orders them like the bytes
+static inline duckdb::hugeint_t ConvertUUID(const pg_uuid_t *pg_uuid) {
+  uint64_t upper = 0;
+  uint64_t lower = 0;
+  for (int i = 0; i < 8; i++) {
+    upper = (upper << 8) | pg_uuid->data[i];
+  }
+  for (int i = 8; i < 16; i++) {
+    lower = (lower << 8) | pg_uuid->data[i];
+  }
+  duckdb::hugeint_t result;
+  result.upper = static_cast<int64_t>(upper ^ (uint64_t(1) << 63));
+  result.lower = lower;
+  return result;
+}
+
+// money is an int64 in units of the smallest fraction of lc_monetary's
+// currency, with as many decimal places as the locale says
+static uint8_t MoneyScale() {
+  int frac_digits = PGLC_localeconv()->frac_digits;
+  // As in cash_out()
+  return frac_digits >= 0 && frac_digits <= 10 ? frac_digits : 2;
+}
+
+// Types that are 4-byte unsigned integers: object identifiers and their
+// reg* aliases, and transaction and command ids
+static bool IsOidLikeType(Oid typid) {
+  switch (typid) {
+  case OIDOID:
+  case REGPROCOID:
+  case REGPROCEDUREOID:
+  case REGOPEROID:
+  case REGOPERATOROID:
+  case REGCLASSOID:
+  case REGTYPEOID:
+  case REGCONFIGOID:
+  case REGDICTIONARYOID:
+  case REGNAMESPACEOID:
+  case REGROLEOID:
+  case REGCOLLATIONOID:
+  case XIDOID:
+  case CIDOID:
+    return true;
+  default:
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Numeric
+//------------------------------------------------------------------------------
+
+/*
+ * On-disk layout of numeric, which numeric.c keeps private; unchanged since
+ * the short format was introduced in 9.1. The value is a sign and a sequence
+ * of base-10000 digits, the first of which has weight NBASE^weight.
+ */
+using NumericDigit = int16;
+constexpr int NUMERIC_NBASE = 10000;
+constexpr int NUMERIC_DEC_DIGITS = 4;
+
+constexpr uint16 NUMERIC_SIGN_MASK = 0xC000;
+constexpr uint16 NUMERIC_NEG = 0x4000;
+constexpr uint16 NUMERIC_SHORT = 0x8000;
+constexpr uint16 NUMERIC_SPECIAL = 0xC000;
+constexpr uint16 NUMERIC_SHORT_SIGN_MASK = 0x2000;
+constexpr uint16 NUMERIC_SHORT_WEIGHT_SIGN_MASK = 0x0040;
+constexpr uint16 NUMERIC_SHORT_WEIGHT_MASK = 0x003F;
+
+struct NumericHeader {
+  int32 vl_len_;
+  uint16 n_header;
+  // Long format only: the weight, followed by the digits
+  int16 n_weight;
+};
+
+struct NumericDigits {
+  bool negative;
+  int weight;
+  const NumericDigit *digits;
+  int ndigits;
+};
+
+// Returns false for NaN and the infinities. `num` must have a 4-byte header.
+static bool ReadNumericDigits(Numeric num, NumericDigits &out) {
+  auto *header = reinterpret_cast<const NumericHeader *>(num);
+  uint16 flags = header->n_header & NUMERIC_SIGN_MASK;
+  if (flags == NUMERIC_SPECIAL) {
+    return false;
+  }
+  Size header_size;
+  if (flags == NUMERIC_SHORT) {
+    out.negative = (header->n_header & NUMERIC_SHORT_SIGN_MASK) != 0;
+    out.weight = header->n_header & NUMERIC_SHORT_WEIGHT_MASK;
+    if (header->n_header & NUMERIC_SHORT_WEIGHT_SIGN_MASK) {
+      out.weight |= ~NUMERIC_SHORT_WEIGHT_MASK;
+    }
+    header_size = VARHDRSZ + sizeof(uint16);
+  } else {
+    out.negative = flags == NUMERIC_NEG;
+    out.weight = header->n_weight;
+    header_size = VARHDRSZ + sizeof(uint16) + sizeof(int16);
+  }
+  out.digits = reinterpret_cast<const NumericDigit *>(
+      reinterpret_cast<const char *>(num) + header_size);
+  out.ndigits = (VARSIZE(num) - header_size) / sizeof(NumericDigit);
+  return true;
+}
+
+template <class T> static inline T Pow10(int exponent) {
+  T result = 1;
+  for (int i = 0; i < exponent; i++) {
+    result *= 10;
+  }
+  return result;
+}
+
+/*
+ * The value of `num` times 10^scale, i.e. the backing integer of a DuckDB
+ * DECIMAL with that scale, computed from the digits without going through
+ * text or float. Digits below the scale are dropped; numeric columns of that
+ * scale have none. Returns false for NaN and the infinities.
+ */
+template <class T>
+static bool NumericToDecimal(Numeric num, int scale, T &result) {
+  NumericDigits var;
+  if (!ReadNumericDigits(num, var)) {
+    return false;
+  }
+  T acc = 0;
+  // Power of ten of the unit of `acc`, once it has a digit
+  int acc_exponent = -1;
+  for (int i = 0; i < var.ndigits; i++) {
+    int exponent = NUMERIC_DEC_DIGITS * (var.weight - i) + scale;
+    if (exponent <= -NUMERIC_DEC_DIGITS) {
+      break;
+    }
+    if (exponent < 0) {
+      // Only the leading decimal digits of this group are above the scale
+      acc = acc * Pow10<T>(NUMERIC_DEC_DIGITS + exponent) +
+            T(var.digits[i] / Pow10<int>(-exponent));
+      acc_exponent = 0;
+      break;
+    }
+    acc = acc * T(NUMERIC_NBASE) + T(var.digits[i]);
+    acc_exponent = exponent;
+  }
+  if (acc_exponent > 0) {
+    acc *= Pow10<T>(acc_exponent);
+  }
+  result = var.negative ? -acc : acc;
+  return true;
+}
+
+// The DuckDB DECIMAL of a numeric column with typmod `typmod`, if it has one
+// DuckDB can hold: a precision of at most 38 and a scale within [0, precision]
+static bool NumericTypmodToDecimal(int32 typmod, uint8_t &width,
+                                   uint8_t &scale) {
+  if (typmod < static_cast<int32>(VARHDRSZ)) {
+    return false;
+  }
+  int32 precision = ((typmod - VARHDRSZ) >> 16) & 0xffff;
+  // Scales may be negative since PG 15, stored as 11-bit two's complement
+  int32 numeric_scale = (((typmod - VARHDRSZ) & 0x7ff) ^ 1024) - 1024;
+  if (precision < 1 || precision > duckdb::Decimal::MAX_WIDTH_DECIMAL ||
+      numeric_scale < 0 || numeric_scale > precision) {
+    return false;
+  }
+  width = static_cast<uint8_t>(precision);
+  scale = static_cast<uint8_t>(numeric_scale);
+  return true;
+}
+
+// Write `value` into a DECIMAL vector of any physical type, or null it for
+// values DECIMAL has no room for.
+static void WriteNumericDecimal(Datum value, duckdb::Vector &result,
+                                idx_t offset) {
+  Numeric num = DatumGetNumeric(value);
+  int scale = duckdb::DecimalType::GetScale(result.GetType());
+  bool ok;
+  switch (result.GetType().InternalType()) {
+  case duckdb::PhysicalType::INT16:
+    ok = NumericToDecimal(num, scale,
+                          duckdb::FlatVector::GetData<int16_t>(result)[offset]);
+    break;
+  case duckdb::PhysicalType::INT32:
+    ok = NumericToDecimal(num, scale,
+                          duckdb::FlatVector::GetData<int32_t>(result)[offset]);
+    break;
+  case duckdb::PhysicalType::INT64:
+    ok = NumericToDecimal(num, scale,
+                          duckdb::FlatVector::GetData<int64_t>(result)[offset]);
+    break;
+  default:
+    ok = NumericToDecimal(
+        num, scale,
+        duckdb::FlatVector::GetData<duckdb::hugeint_t>(result)[offset]);
+    break;
+  }
+  if (!ok) {
+    duckdb::FlatVector::SetNull(result, offset, true);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Enums
+//------------------------------------------------------------------------------
+
+struct EnumLabel {
+  Oid oid;
+  float4 sort_order;
+  std::string label;
+};
+
+// The labels of enum `typid` in their sort order, which is also the order of
+// the DuckDB ENUM dictionary
+static duckdb::vector<EnumLabel> GetEnumLabels(Oid typid) {
+  duckdb::vector<EnumLabel> labels;
+  CatCList *list = SearchSysCacheList1(ENUMTYPOIDNAME, ObjectIdGetDatum(typid));
+  for (int i = 0; i < list->n_members; i++) {
+    auto *form = reinterpret_cast<Form_pg_enum>(
+        GETSTRUCT(&list->members[i]->tuple));
+    labels.push_back(
+        EnumLabel{form->oid, form->enumsortorder, NameStr(form->enumlabel)});
+  }
+  ReleaseCatCacheList(list);
+  std::sort(labels.begin(), labels.end(),
+            [](const EnumLabel &a, const EnumLabel &b) {
+              return a.sort_order < b.sort_order;
+            });
+  return labels;
+}
+
+static duckdb::LogicalType ConvertEnumType(Oid typid) {
+  auto labels = GetEnumLabels(typid);
+  duckdb::Vector dictionary(duckdb::LogicalType::VARCHAR, labels.size());
+  auto data = duckdb::FlatVector::GetData<duckdb::string_t>(dictionary);
+  for (idx_t i = 0; i < labels.size(); i++) {
+    data[i] = duckdb::StringVector::AddString(dictionary, labels[i].label);
+  }
+  return duckdb::LogicalType::ENUM(dictionary, labels.size());
+}
+
+// The dictionary index type depends on the number of labels
+static void WriteEnumPosition(duckdb::Vector &result, idx_t offset,
+                              idx_t position) {
+  switch (result.GetType().InternalType()) {
+  case duckdb::PhysicalType::UINT8:
+    duckdb::FlatVector::GetData<uint8_t>(result)[offset] =
+        static_cast<uint8_t>(position);
+    break;
+  case duckdb::PhysicalType::UINT16:
+    duckdb::FlatVector::GetData<uint16_t>(result)[offset] =
+        static_cast<uint16_t>(position);
+    break;
+  case duckdb::PhysicalType::UINT32:
+    duckdb::FlatVector::GetData<uint32_t>(result)[offset] =
+        static_cast<uint32_t>(position);
+    break;
+  default:
+    elog(ERROR, "unexpected physical type for DuckDB enum");
+  }
+}
+
+static void WriteEnumValue(Datum value, duckdb::Vector &result, idx_t offset) {
+  HeapTuple tuple = SearchSysCache1(ENUMOID, value);
+  if (!HeapTupleIsValid(tuple)) {
+    elog(ERROR, "invalid internal value for enum: %u",
+         DatumGetObjectId(value));
+  }
+  auto *form = reinterpret_cast<Form_pg_enum>(GETSTRUCT(tuple));
+  auto position =
+      duckdb::EnumType::GetPos(result.GetType(), NameStr(form->enumlabel));
+  ReleaseSysCache(tuple);
+  if (position < 0) {
+    // The label was added after the result was described
+    elog(ERROR, "enum value was added during the query: %u",
+         DatumGetObjectId(value));
+  }
+  WriteEnumPosition(result, offset, position);
+}
+
+//------------------------------------------------------------------------------
+// JSONB
+//------------------------------------------------------------------------------
+
+// Append `str` as a JSON string literal, escaped like escape_json() does
+static void AppendJsonString(std::string &out, const char *str, int len) {
+  static const char hex[] = "0123456789abcdef";
+  out += '"';
+  for (int i = 0; i < len; i++) {
+    unsigned char c = static_cast<unsigned char>(str[i]);
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (c < ' ') {
+        out += "\\u00";
+        out += hex[c >> 4];
+        out += hex[c & 0xf];
+      } else {
+        out += static_cast<char>(c);
+      }
+      break;
+    }
+  }
+  out += '"';
+}
+
+static void AppendJsonbScalar(std::string &out, const JsonbValue &value) {
+  switch (value.type) {
+  case jbvNull:
+    out += "null";
+    break;
+  case jbvString:
+    AppendJsonString(out, value.val.string.val, value.val.string.len);
+    break;
+  case jbvNumeric: {
+    char *str = DatumGetCString(
+        DirectFunctionCall1(numeric_out, NumericGetDatum(value.val.numeric)));
+    out += str;
+    pfree(str);
+    break;
+  }
+  case jbvBool:
+    out += value.val.boolean ? "true" : "false";
+    break;
+  default:
+    elog(ERROR, "unexpected jsonb value type: %d", value.type);
+  }
+}
+
+/*
+ * Write `jsonb` as JSON text into `out`, walking its binary container once,
+ * in the same layout as jsonb_out(). Containers are never materialized and
+ * strings are copied straight from the container.
+ */
+static void JsonbToJsonText(Jsonb *jsonb, std::string &out) {
+  out.clear();
+  JsonbIterator *it = JsonbIteratorInit(&jsonb->root);
+  JsonbValue value;
+  JsonbIteratorToken token;
+  // A top-level scalar is stored as a one-element array without brackets
+  bool raw_scalar = false;
+  bool need_comma = false;
+  while ((token = JsonbIteratorNext(&it, &value, false)) != WJB_DONE) {
+    switch (token) {
+    case WJB_BEGIN_ARRAY:
+      if (value.val.array.rawScalar) {
+        raw_scalar = true;
+        break;
+      }
+      if (need_comma) {
+        out += ", ";
+      }
+      out += '[';
+      need_comma = false;
+      break;
+    case WJB_BEGIN_OBJECT:
+      if (need_comma) {
+        out += ", ";
+      }
+      out += '{';
+      need_comma = false;
+      break;
+    case WJB_KEY:
+      if (need_comma) {
+        out += ", ";
+      }
+      AppendJsonString(out, value.val.string.val, value.val.string.len);
+      out += ": ";
+      need_comma = false;
+      break;
+    case WJB_VALUE:
+    case WJB_ELEM:
+      if (need_comma) {
+        out += ", ";
+      }
+      AppendJsonbScalar(out, value);
+      need_comma = true;
+      break;
+    case WJB_END_ARRAY:
+      if (!raw_scalar) {
+        out += ']';
+      }
+      need_comma = true;
+      break;
+    case WJB_END_OBJECT:
+      out += '}';
+      need_comma = true;
+      break;
+    default:
+      elog(ERROR, "unexpected jsonb iterator token: %d", token);
+    }
+  }
+}
+
+// `json` is the caller's buffer for the text, which it may reuse across values
+static void WriteJsonb(Datum value, duckdb::Vector &result, idx_t offset,
+                       std::string &json) {
+  JsonbToJsonText(DatumGetJsonbP(value), json);
+  duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
+      duckdb::StringVector::AddString(result, json.data(), json.size());
+}
+
 //------------------------------------------------------------------------------
 // Detoasting
 //------------------------------------------------------------------------------
@@ -72,7 +544,8 @@ Datum DetoastPostgresDatum(struct varlena *attr, bool *should_free) {
 // Type conversion - PostgreSQL to DuckDB
 //------------------------------------------------------------------------------
 
-static duckdb::LogicalType ConvertPostgresToBaseDuckType(Oid typid) {
+static duckdb::LogicalType ConvertPostgresToBaseDuckType(Oid typid,
+                                                         int32 typmod) {
   switch (typid) {
   // Boolean
   case BOOLOID:
@@ -92,17 +565,31 @@ static duckdb::LogicalType ConvertPostgresToBaseDuckType(Oid typid) {
   case FLOAT8OID:
     return duckdb::LogicalType::DOUBLE;
 
-  // Numeric/Decimal
-  case NUMERICOID:
-    return duckdb::LogicalType::DOUBLE; // Simplified - convert numeric to double
+  // Numeric/Decimal: exact when the typmod fits a DECIMAL, DOUBLE otherwise
+  case NUMERICOID: {
+    uint8_t width;
+    uint8_t scale;
+    if (NumericTypmodToDecimal(typmod, width, scale)) {
+      return duckdb::LogicalType::DECIMAL(width, scale);
+    }
+    return duckdb::LogicalType::DOUBLE;
+  }
+  case MONEYOID:
+    // Any int64 has 19 digits at most, more than an int64 DECIMAL holds
+    return duckdb::LogicalType::DECIMAL(19, MoneyScale());
 
   // String types
   case TEXTOID:
   case VARCHAROID:
   case BPCHAROID:
   case NAMEOID:
+  case CHAROID:
     return duckdb::LogicalType::VARCHAR;
 
+  // Binary
+  case BYTEAOID:
+    return duckdb::LogicalType::BLOB;
+
   // Date/Time types
   case DATEOID:
     return duckdb::LogicalType::DATE;
@@ -112,6 +599,15 @@ static duckdb::LogicalType ConvertPostgresToBaseDuckType(Oid typid) {
     return duckdb::LogicalType::TIMESTAMP_TZ;
   case TIMEOID:
     return duckdb::LogicalType::TIME;
+  case TIMETZOID:
+    return duckdb::LogicalType::TIME_TZ;
+  case INTERVALOID:
+    return duckdb::LogicalType::INTERVAL;
+
+  // Network addresses, in their text form: DuckDB has no built-in type
+  case INETOID:
+  case CIDROID:
+    return duckdb::LogicalType::VARCHAR;
 
   // UUID
   case UUIDOID:
@@ -123,43 +619,98 @@ static duckdb::LogicalType ConvertPostgresToBaseDuckType(Oid typid) {
     return duckdb::LogicalType::JSON();
 
   default:
+    if (IsOidLikeType(typid)) {
+      return duckdb::LogicalType::UINTEGER;
+    }
+    if (type_is_enum(typid)) {
+      return ConvertEnumType(typid);
+    }
     return duckdb::LogicalType::SQLNULL; // Unsupported type
   }
 }
 
-duckdb::LogicalType ConvertPostgresToDuckColumnType(Form_pg_attribute &attribute) {
-  auto base_type = ConvertPostgresToBaseDuckType(attribute->atttypid);
+// Whether `typid` is a true (varlena) array type. Fixed-length types like
+// name also have an element type, for subscripting.
+static bool IsArrayType(Oid typid) {
+  return OidIsValid(get_element_type(typid)) && get_typlen(typid) == -1;
+}
 
-  if (base_type.id() == duckdb::LogicalTypeId::SQLNULL) {
-    // Unsupported type
-    elog(WARNING, "Unsupported PostgreSQL type OID: %u, using VARCHAR", attribute->atttypid);
-    return duckdb::LogicalType::VARCHAR;
+duckdb::LogicalType ConvertPostgresToDuckType(Oid typid, int32 typmod) {
+  if (IsArrayType(typid)) {
+    // DuckDB uses LIST for arrays. Multi-dimensional arrays are flattened.
+    // The typmod of an array is that of its elements.
+    auto elem_type = ConvertPostgresToDuckType(get_element_type(typid), typmod);
+    if (elem_type.id() == duckdb::LogicalTypeId::SQLNULL) {
+      return duckdb::LogicalType::SQLNULL;
+    }
+    return duckdb::LogicalType::LIST(elem_type);
   }
 
-  // Handle array types
-  Oid elem_type = get_element_type(attribute->atttypid);
-  if (elem_type != InvalidOid) {
-    // This is an array type
-    auto elem_base_type = ConvertPostgresToBaseDuckType(elem_type);
-    if (elem_base_type.id() == duckdb::LogicalTypeId::SQLNULL) {
-      elog(WARNING, "Unsupported array element type OID: %u", elem_type);
-      return duckdb::LogicalType::VARCHAR;
+  if (type_is_rowtype(typid)) {
+    // The fields of an anonymous record are not known from its type
+    if (typid == RECORDOID && typmod < 0) {
+      return duckdb::LogicalType::SQLNULL;
     }
-
-    // DuckDB uses LIST for arrays
-    int dimensions = attribute->attndims;
-    if (dimensions == 0) {
-      dimensions = 1; // Default to 1D array
+    TupleDesc tupdesc = lookup_rowtype_tupdesc(typid, typmod);
+    duckdb::child_list_t<duckdb::LogicalType> fields;
+    for (int i = 0; i < tupdesc->natts; i++) {
+      Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+      if (attr->attisdropped) {
+        continue;
+      }
+      auto field_type =
+          ConvertPostgresToDuckType(attr->atttypid, attr->atttypmod);
+      if (field_type.id() == duckdb::LogicalTypeId::SQLNULL) {
+        ReleaseTupleDesc(tupdesc);
+        return duckdb::LogicalType::SQLNULL;
+      }
+      fields.emplace_back(NameStr(attr->attname), std::move(field_type));
     }
+    ReleaseTupleDesc(tupdesc);
+    return duckdb::LogicalType::STRUCT(std::move(fields));
+  }
+
+  return ConvertPostgresToBaseDuckType(typid, typmod);
+}
 
-    duckdb::LogicalType list_type = elem_base_type;
-    for (int i = 0; i < dimensions; i++) {
-      list_type = duckdb::LogicalType::LIST(list_type);
+// `type` with its enums, at any depth, replaced by VARCHAR
+static duckdb::LogicalType EnumsToVarchar(const duckdb::LogicalType &type) {
+  switch (type.id()) {
+  case duckdb::LogicalTypeId::ENUM:
+    return duckdb::LogicalType::VARCHAR;
+  case duckdb::LogicalTypeId::LIST:
+    return duckdb::LogicalType::LIST(
+        EnumsToVarchar(duckdb::ListType::GetChildType(type)));
+  case duckdb::LogicalTypeId::STRUCT: {
+    duckdb::child_list_t<duckdb::LogicalType> fields;
+    for (auto &field : duckdb::StructType::GetChildTypes(type)) {
+      fields.emplace_back(field.first, EnumsToVarchar(field.second));
     }
-    return list_type;
+    return duckdb::LogicalType::STRUCT(std::move(fields));
   }
+  default:
+    return type;
+  }
+}
 
-  return base_type;
+duckdb::LogicalType ConvertPostgresToDuckLakeType(Oid typid, int32 typmod) {
+  return EnumsToVarchar(ConvertPostgresToDuckType(typid, typmod));
+}
+
+duckdb::LogicalType
+ConvertPostgresToDuckColumnType(Form_pg_attribute &attribute) {
+  auto type =
+      ConvertPostgresToDuckType(attribute->atttypid, attribute->atttypmod);
+
+  if (type.id() == duckdb::LogicalTypeId::SQLNULL ||
+      (type.id() == duckdb::LogicalTypeId::LIST &&
+       duckdb::ListType::GetChildType(type).id() ==
+           duckdb::LogicalTypeId::SQLNULL)) {
+    // Unsupported type
+    elog(WARNING, "Unsupported PostgreSQL type OID: %u, using VARCHAR", attribute->atttypid);
+    return duckdb::LogicalType::VARCHAR;
+  }
+  return type;
 }
 
 //------------------------------------------------------------------------------
@@ -193,17 +744,51 @@ void ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &resu
     break;
 
   case NUMERICOID: {
-    // Convert numeric to double
+    if (result.GetType().id() == duckdb::LogicalTypeId::DECIMAL) {
+      WriteNumericDecimal(value, result, offset);
+      break;
+    }
+    // Unconstrained numeric: convert to double
     duckdb::FlatVector::GetData<double>(result)[offset] =
         DatumGetFloat8(DirectFunctionCall1(numeric_float8, value));
     break;
   }
 
+  case MONEYOID:
+    duckdb::FlatVector::GetData<duckdb::hugeint_t>(result)[offset] =
+        duckdb::hugeint_t(DatumGetCash(value));
+    break;
+
+  case CHAROID: {
+    // "char" is a single byte, or the empty string for \0
+    char c = DatumGetChar(value);
+    duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
+        duckdb::StringVector::AddString(result, &c, c ? 1 : 0);
+    break;
+  }
+
+  case BYTEAOID: {
+    bytea *bytes = DatumGetByteaPP(value);
+    duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
+        duckdb::StringVector::AddStringOrBlob(result, VARDATA_ANY(bytes),
+                                              VARSIZE_ANY_EXHDR(bytes));
+    break;
+  }
+
+  case NAMEOID: {
+    // name is a fixed-length, NUL-padded C string, not a varlena
+    const char *str = NameStr(*DatumGetName(value));
+    duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
+        duckdb::StringVector::AddString(result, str, strlen(str));
+    break;
+  }
+
   case TEXTOID:
   case VARCHAROID:
   case BPCHAROID:
-  case NAMEOID: {
-    text *txt = DatumGetTextP(value);
+  case JSONOID: {
+    // json is kept as its text
+    text *txt = DatumGetTextPP(value);
     char *str = VARDATA_ANY(txt);
     size_t len = VARSIZE_ANY_EXHDR(txt);
     duckdb::string_t duck_str(str, len);
@@ -212,55 +797,85 @@ void ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &resu
     break;
   }
 
-  case DATEOID: {
-    DateADT pg_date = DatumGetDateADT(value);
-    // PostgreSQL dates are days since 2000-01-01
-    // DuckDB dates are days since 1970-01-01
+  case DATEOID:
     duckdb::FlatVector::GetData<duckdb::date_t>(result)[offset] =
-        duckdb::date_t(pg_date + DUCK_DATE_OFFSET);
+        duckdb::date_t(ConvertDate(DatumGetDateADT(value)));
     break;
-  }
 
-  case TIMESTAMPOID: {
-    Timestamp pg_ts = DatumGetTimestamp(value);
-    // PostgreSQL timestamps are microseconds since 2000-01-01
-    // DuckDB timestamps are microseconds since 1970-01-01
+  case TIMESTAMPOID:
     duckdb::FlatVector::GetData<duckdb::timestamp_t>(result)[offset] =
-        duckdb::timestamp_t(pg_ts + DUCK_TIMESTAMP_OFFSET);
+        duckdb::timestamp_t(ConvertTimestamp(DatumGetTimestamp(value)));
     break;
-  }
 
-  case TIMESTAMPTZOID: {
-    TimestampTz pg_ts = DatumGetTimestampTz(value);
+  case TIMESTAMPTZOID:
     duckdb::FlatVector::GetData<duckdb::timestamp_t>(result)[offset] =
-        duckdb::timestamp_t(pg_ts + DUCK_TIMESTAMP_OFFSET);
+        duckdb::timestamp_t(ConvertTimestamp(DatumGetTimestampTz(value)));
+    break;
+
+  case TIMEOID:
+    // Both are microseconds since midnight
+    duckdb::FlatVector::GetData<duckdb::dtime_t>(result)[offset] =
+        duckdb::dtime_t(DatumGetTimeADT(value));
+    break;
+
+  case TIMETZOID: {
+    // PG keeps the zone in seconds west of UTC, DuckDB the offset east of it
+    TimeTzADT *timetz = DatumGetTimeTzADTP(value);
+    duckdb::FlatVector::GetData<duckdb::dtime_tz_t>(result)[offset] =
+        duckdb::dtime_tz_t(duckdb::dtime_t(timetz->time), -timetz->zone);
     break;
   }
 
-  case UUIDOID: {
-    pg_uuid_t *pg_uuid = DatumGetUUIDP(value);
-    duckdb::hugeint_t uuid_value;
-    // Copy UUID bytes
-    memcpy(&uuid_value, pg_uuid->data, 16);
-    duckdb::FlatVector::GetData<duckdb::hugeint_t>(result)[offset] = uuid_value;
+  case INTERVALOID: {
+    Interval *pg_interval = DatumGetIntervalP(value);
+#if PG_VERSION_NUM >= 170000
+    // DuckDB has no infinite intervals
+    if (INTERVAL_NOT_FINITE(pg_interval)) {
+      duckdb::FlatVector::SetNull(result, offset, true);
+      break;
+    }
+#endif
+    duckdb::interval_t interval;
+    interval.months = pg_interval->month;
+    interval.days = pg_interval->day;
+    interval.micros = pg_interval->time;
+    duckdb::FlatVector::GetData<duckdb::interval_t>(result)[offset] = interval;
     break;
   }
 
-  case JSONOID:
-  case JSONBOID: {
-    // Convert JSONB to string
-    // jsonb_out returns cstring
-    Datum json_datum = DirectFunctionCall1(jsonb_out, value);
-    char *json_str = DatumGetCString(json_datum);
-    duckdb::string_t duck_str(json_str, strlen(json_str));
+  case UUIDOID:
+    duckdb::FlatVector::GetData<duckdb::hugeint_t>(result)[offset] =
+        ConvertUUID(DatumGetUUIDP(value));
+    break;
+
+  case INETOID:
+  case CIDROID: {
+    char *str = DatumGetCString(
+        DirectFunctionCall1(attr_type == INETOID ? inet_out : cidr_out, value));
     duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
-        duckdb::StringVector::AddString(result, duck_str);
-    pfree(json_str);
+        duckdb::StringVector::AddString(result, str, strlen(str));
+    pfree(str);
+    break;
+  }
+
+  case JSONBOID: {
+    std::string json;
+    WriteJsonb(value, result, offset, json);
     break;
   }
 
   default: {
-    // Unsupported type - convert to string representation
+    if (IsOidLikeType(attr_type)) {
+      duckdb::FlatVector::GetData<uint32_t>(result)[offset] =
+          DatumGetObjectId(value);
+      break;
+    }
+    if (type_is_enum(attr_type)) {
+      WriteEnumValue(value, result, offset);
+      break;
+    }
+    // Unsupported type - convert to string representation. The column type
+    // was mapped to VARCHAR, with a warning, when the result was described.
     Oid typoutput;
     bool typisvarlena;
     getTypeOutputInfo(attr_type, &typoutput, &typisvarlena);
@@ -269,10 +884,401 @@ void ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &resu
     duckdb::FlatVector::GetData<duckdb::string_t>(result)[offset] =
         duckdb::StringVector::AddString(result, duck_str);
     pfree(str);
-    elog(WARNING, "Converting unsupported type OID %u to string", attr_type);
     break;
   }
   }
 }
 
+// Write `value` of type `typid` at `offset` of `result`, recursing into arrays
+// (LIST) and composites (STRUCT). The shape of the output follows the type of
+// `result`.
+static void WritePostgresValue(Oid typid, Datum value, duckdb::Vector &result,
+                               idx_t offset) {
+  switch (result.GetType().id()) {
+  case duckdb::LogicalTypeId::LIST: {
+    ArrayType *array = DatumGetArrayTypeP(value);
+    Oid elem_type = ARR_ELEMTYPE(array);
+    int16 elem_len;
+    bool elem_byval;
+    char elem_align;
+    get_typlenbyvalalign(elem_type, &elem_len, &elem_byval, &elem_align);
+    Datum *elems;
+    bool *elem_nulls;
+    int num_elems;
+    deconstruct_array(array, elem_type, elem_len, elem_byval, elem_align,
+                      &elems, &elem_nulls, &num_elems);
+
+    auto list_size = duckdb::ListVector::GetListSize(result);
+    duckdb::ListVector::Reserve(result, list_size + num_elems);
+    auto &child = duckdb::ListVector::GetEntry(result);
+    for (int i = 0; i < num_elems; i++) {
+      if (elem_nulls[i]) {
+        duckdb::FlatVector::SetNull(child, list_size + i, true);
+      } else {
+        WritePostgresValue(elem_type, elems[i], child, list_size + i);
+      }
+    }
+    auto &entry = duckdb::ListVector::GetData(result)[offset];
+    entry.offset = list_size;
+    entry.length = num_elems;
+    duckdb::ListVector::SetListSize(result, list_size + num_elems);
+
+    pfree(elems);
+    pfree(elem_nulls);
+    break;
+  }
+
+  case duckdb::LogicalTypeId::STRUCT: {
+    HeapTupleHeader td = DatumGetHeapTupleHeader(value);
+    TupleDesc tupdesc = lookup_rowtype_tupdesc(HeapTupleHeaderGetTypeId(td),
+                                               HeapTupleHeaderGetTypMod(td));
+    HeapTupleData tuple;
+    tuple.t_len = HeapTupleHeaderGetDatumLength(td);
+    ItemPointerSetInvalid(&tuple.t_self);
+    tuple.t_tableOid = InvalidOid;
+    tuple.t_data = td;
+
+    Datum *values = static_cast<Datum *>(palloc(tupdesc->natts * sizeof(Datum)));
+    bool *nulls = static_cast<bool *>(palloc(tupdesc->natts * sizeof(bool)));
+    heap_deform_tuple(&tuple, tupdesc, values, nulls);
+
+    auto &children = duckdb::StructVector::GetEntries(result);
+    idx_t child_idx = 0;
+    for (int i = 0; i < tupdesc->natts; i++) {
+      Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+      if (attr->attisdropped) {
+        continue;
+      }
+      auto &child = *children[child_idx++];
+      if (nulls[i]) {
+        duckdb::FlatVector::SetNull(child, offset, true);
+      } else {
+        WritePostgresValue(attr->atttypid, values[i], child, offset);
+      }
+    }
+
+    pfree(values);
+    pfree(nulls);
+    ReleaseTupleDesc(tupdesc);
+    break;
+  }
+
+  default:
+    ConvertPostgresToDuckValue(typid, value, result, offset);
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Column conversion - batches of PostgreSQL Datums to DuckDB Vector
+//------------------------------------------------------------------------------
+
+struct BoolOp {
+  using TYPE = bool;
+  static bool Get(Datum value) { return DatumGetBool(value); }
+};
+struct Int16Op {
+  using TYPE = int16_t;
+  static int16_t Get(Datum value) { return DatumGetInt16(value); }
+};
+struct Int32Op {
+  using TYPE = int32_t;
+  static int32_t Get(Datum value) { return DatumGetInt32(value); }
+};
+struct Int64Op {
+  using TYPE = int64_t;
+  static int64_t Get(Datum value) { return DatumGetInt64(value); }
+};
+struct MoneyOp {
+  using TYPE = duckdb::hugeint_t;
+  static duckdb::hugeint_t Get(Datum value) {
+    return duckdb::hugeint_t(DatumGetCash(value));
+  }
+};
+struct Float4Op {
+  using TYPE = float;
+  static float Get(Datum value) { return DatumGetFloat4(value); }
+};
+struct Float8Op {
+  using TYPE = double;
+  static double Get(Datum value) { return DatumGetFloat8(value); }
+};
+struct OidOp {
+  using TYPE = uint32_t;
+  static uint32_t Get(Datum value) { return DatumGetObjectId(value); }
+};
+struct TimeOp {
+  using TYPE = duckdb::dtime_t;
+  static duckdb::dtime_t Get(Datum value) {
+    return duckdb::dtime_t(DatumGetTimeADT(value));
+  }
+};
+
+PGDUCKLAKE_TARGET_CLONES
+static void ConvertDates(const Datum *values, idx_t count, int32_t *out) {
+  for (idx_t i = 0; i < count; i++) {
+    out[i] = ConvertDate(static_cast<int32_t>(values[i]));
+  }
+}
+
+PGDUCKLAKE_TARGET_CLONES
+static void ConvertTimestamps(const Datum *values, idx_t count, int64_t *out) {
+  for (idx_t i = 0; i < count; i++) {
+    out[i] = ConvertTimestamp(static_cast<int64_t>(values[i]));
+  }
+}
+
+// Fixed-width by-value columns are converted over every row, nulls included:
+// their datums are zero, and skipping them would stop the loop vectorizing.
+template <class OP>
+void PostgresColumnConverter::ConvertFixedColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool * /*nulls*/, idx_t count, duckdb::Vector &result) {
+  auto data = duckdb::FlatVector::GetData<typename OP::TYPE>(result);
+  for (idx_t i = 0; i < count; i++) {
+    data[i] = OP::Get(values[i]);
+  }
+}
+
+void PostgresColumnConverter::ConvertDateColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool * /*nulls*/, idx_t count, duckdb::Vector &result) {
+  static_assert(sizeof(duckdb::date_t) == sizeof(int32_t), "date_t layout");
+  ConvertDates(values, count,
+               reinterpret_cast<int32_t *>(
+                   duckdb::FlatVector::GetData<duckdb::date_t>(result)));
+}
+
+void PostgresColumnConverter::ConvertTimestampColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool * /*nulls*/, idx_t count, duckdb::Vector &result) {
+  static_assert(sizeof(duckdb::timestamp_t) == sizeof(int64_t),
+                "timestamp_t layout");
+  ConvertTimestamps(values, count,
+                    reinterpret_cast<int64_t *>(
+                        duckdb::FlatVector::GetData<duckdb::timestamp_t>(
+                            result)));
+}
+
+void PostgresColumnConverter::ConvertUUIDColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  auto data = duckdb::FlatVector::GetData<duckdb::hugeint_t>(result);
+  for (idx_t i = 0; i < count; i++) {
+    if (!nulls[i]) {
+      data[i] = ConvertUUID(DatumGetUUIDP(values[i]));
+    }
+  }
+}
+
+// Short-header values are read in place rather than expanded to a 4-byte
+// header first; only toasted values are detoasted.
+void PostgresColumnConverter::ConvertTextColumn(
+    const PostgresColumnConverter &converter, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    auto *attr = reinterpret_cast<varlena *>(values[i]);
+    if (VARATT_IS_EXTENDED(attr) && !VARATT_IS_SHORT(attr)) {
+      bool should_free = false;
+      auto *txt = reinterpret_cast<text *>(
+          DetoastPostgresDatum(attr, &should_free));
+      data[i] = duckdb::StringVector::AddString(result, VARDATA_ANY(txt),
+                                                VARSIZE_ANY_EXHDR(txt));
+      if (should_free) {
+        pfree(txt);
+      }
+    } else if (converter.reference_strings) {
+      auto size = static_cast<uint32_t>(VARSIZE_ANY_EXHDR(attr));
+      data[i] = duckdb::string_t(VARDATA_ANY(attr), size);
+    } else {
+      data[i] = duckdb::StringVector::AddString(result, VARDATA_ANY(attr),
+                                                VARSIZE_ANY_EXHDR(attr));
+    }
+  }
+}
+
+template <class T>
+void PostgresColumnConverter::ConvertEnumColumn(
+    const PostgresColumnConverter &converter, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  auto data = duckdb::FlatVector::GetData<T>(result);
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    auto position = converter.enum_positions.find(DatumGetObjectId(values[i]));
+    if (position == converter.enum_positions.end()) {
+      // Added after the result was described, or not a value of this enum
+      WriteEnumValue(values[i], result, i);
+      continue;
+    }
+    data[i] = static_cast<T>(position->second);
+  }
+}
+
+void PostgresColumnConverter::ConvertGenericColumn(
+    const PostgresColumnConverter &converter, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    if (converter.type_len == -1) {
+      bool should_free = false;
+      Datum detoasted_value = DetoastPostgresDatum(
+          reinterpret_cast<varlena *>(values[i]), &should_free);
+      ConvertPostgresToDuckValue(converter.type_oid, detoasted_value, result,
+                                 i);
+      if (should_free) {
+        pfree(DatumGetPointer(detoasted_value));
+      }
+    } else {
+      ConvertPostgresToDuckValue(converter.type_oid, values[i], result, i);
+    }
+  }
+}
+
+// One text buffer serves the whole batch, and is freed with it
+void PostgresColumnConverter::ConvertJsonbColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  std::string json;
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    bool should_free = false;
+    Datum detoasted_value = DetoastPostgresDatum(
+        reinterpret_cast<varlena *>(values[i]), &should_free);
+    WriteJsonb(detoasted_value, result, i, json);
+    if (should_free) {
+      pfree(DatumGetPointer(detoasted_value));
+    }
+  }
+}
+
+void PostgresColumnConverter::ConvertDecimalColumn(
+    const PostgresColumnConverter & /*converter*/, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      continue;
+    }
+    bool should_free = false;
+    Datum detoasted_value = DetoastPostgresDatum(
+        reinterpret_cast<varlena *>(values[i]), &should_free);
+    WriteNumericDecimal(detoasted_value, result, i);
+    if (should_free) {
+      pfree(DatumGetPointer(detoasted_value));
+    }
+  }
+}
+
+void PostgresColumnConverter::ConvertNestedColumn(
+    const PostgresColumnConverter &converter, const Datum *values,
+    const bool *nulls, idx_t count, duckdb::Vector &result) {
+  for (idx_t i = 0; i < count; i++) {
+    if (nulls[i]) {
+      // Also marks the struct fields invalid
+      duckdb::FlatVector::SetNull(result, i, true);
+      continue;
+    }
+    WritePostgresValue(converter.type_oid, values[i], result, i);
+  }
+}
+
+PostgresColumnConverter::PostgresColumnConverter(Form_pg_attribute attribute,
+                                                 bool reference_strings)
+    : type_oid(attribute->atttypid), type_len(attribute->attlen),
+      reference_strings(reference_strings),
+      type(ConvertPostgresToDuckColumnType(attribute)),
+      convert(ConvertGenericColumn) {
+  if (type.id() == duckdb::LogicalTypeId::LIST ||
+      type.id() == duckdb::LogicalTypeId::STRUCT) {
+    convert = ConvertNestedColumn;
+    return;
+  }
+
+  switch (type_oid) {
+  case BOOLOID:
+    convert = ConvertFixedColumn<BoolOp>;
+    break;
+  case INT2OID:
+    convert = ConvertFixedColumn<Int16Op>;
+    break;
+  case INT4OID:
+    convert = ConvertFixedColumn<Int32Op>;
+    break;
+  case INT8OID:
+    convert = ConvertFixedColumn<Int64Op>;
+    break;
+  case MONEYOID:
+    convert = ConvertFixedColumn<MoneyOp>;
+    break;
+  case FLOAT4OID:
+    convert = ConvertFixedColumn<Float4Op>;
+    break;
+  case FLOAT8OID:
+    convert = ConvertFixedColumn<Float8Op>;
+    break;
+  case DATEOID:
+    convert = ConvertDateColumn;
+    break;
+  case TIMEOID:
+    convert = ConvertFixedColumn<TimeOp>;
+    break;
+  case TIMESTAMPOID:
+  case TIMESTAMPTZOID:
+    convert = ConvertTimestampColumn;
+    break;
+  case UUIDOID:
+    convert = ConvertUUIDColumn;
+    break;
+  case NUMERICOID:
+    if (type.id() == duckdb::LogicalTypeId::DECIMAL) {
+      convert = ConvertDecimalColumn;
+    }
+    break;
+  case TEXTOID:
+  case VARCHAROID:
+  case BPCHAROID:
+  case JSONOID:
+  case BYTEAOID:
+    // bytea bytes are the BLOB as they are
+    convert = ConvertTextColumn;
+    break;
+  case JSONBOID:
+    convert = ConvertJsonbColumn;
+    break;
+  default:
+    if (IsOidLikeType(type_oid)) {
+      convert = ConvertFixedColumn<OidOp>;
+    } else if (type.id() == duckdb::LogicalTypeId::ENUM) {
+      // The dictionary of `type` was built from the same labels in the same
+      // order, so their positions are the DuckDB enum values
+      auto labels = GetEnumLabels(type_oid);
+      for (idx_t i = 0; i < labels.size(); i++) {
+        enum_positions[labels[i].oid] = static_cast<uint32_t>(i);
+      }
+      switch (type.InternalType()) {
+      case duckdb::PhysicalType::UINT8:
+        convert = ConvertEnumColumn<uint8_t>;
+        break;
+      case duckdb::PhysicalType::UINT16:
+        convert = ConvertEnumColumn<uint16_t>;
+        break;
+      default:
+        convert = ConvertEnumColumn<uint32_t>;
+        break;
+      }
+    }
+    // Everything else goes value by value
+    break;
+  }
+}
+
 } // namespace pgducklake
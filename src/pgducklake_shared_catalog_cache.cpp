@@ -0,0 +1,629 @@
+#include "pgducklake/pgducklake_shared_catalog_cache.hpp"
+
+// DuckDB headers first
+#include "duckdb/common/optional_idx.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "common/hashfn.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+}
+
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace pgducklake {
+
+//------------------------------------------------------------------------------
+// Serialization of DuckLakeCatalogInfo
+//------------------------------------------------------------------------------
+
+// Bumped whenever the layout below changes
+constexpr uint32 CATALOG_FORMAT_VERSION = 1;
+
+class CatalogWriter {
+public:
+  void Idx(idx_t value) {
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+  void Bool(bool value) { buffer.push_back(value ? 1 : 0); }
+  void String(const duckdb::string &value) {
+    Idx(value.size());
+    buffer.append(value);
+  }
+  void OptionalString(const duckdb::Value &value) {
+    Bool(!value.IsNull());
+    if (!value.IsNull()) {
+      String(value.ToString());
+    }
+  }
+
+  void Tags(const duckdb::vector<duckdb::DuckLakeTag> &tags) {
+    Idx(tags.size());
+    for (auto &tag : tags) {
+      String(tag.key);
+      String(tag.value);
+    }
+  }
+
+  void Column(const duckdb::DuckLakeColumnInfo &column) {
+    Idx(column.id.index);
+    String(column.name);
+    String(column.type);
+    OptionalString(column.initial_default);
+    OptionalString(column.default_value);
+    Bool(column.nulls_allowed);
+    Tags(column.tags);
+    Idx(column.children.size());
+    for (auto &child : column.children) {
+      Column(child);
+    }
+  }
+
+  duckdb::string buffer;
+};
+
+class CatalogReader {
+public:
+  CatalogReader(const char *data_p, size_t size_p)
+      : data(data_p), size(size_p) {}
+
+  idx_t Idx() {
+    idx_t value = 0;
+    if (Check(sizeof(value))) {
+      memcpy(&value, data + pos, sizeof(value));
+      pos += sizeof(value);
+    }
+    return value;
+  }
+  bool Bool() {
+    if (!Check(1)) {
+      return false;
+    }
+    return data[pos++] != 0;
+  }
+  duckdb::string String() {
+    idx_t len = Idx();
+    if (!Check(len)) {
+      return duckdb::string();
+    }
+    duckdb::string value(data + pos, len);
+    pos += len;
+    return value;
+  }
+  duckdb::Value OptionalString() {
+    if (!Bool()) {
+      return duckdb::Value();
+    }
+    return duckdb::Value(String());
+  }
+
+  duckdb::vector<duckdb::DuckLakeTag> Tags() {
+    duckdb::vector<duckdb::DuckLakeTag> tags;
+    idx_t count = Count();
+    for (idx_t i = 0; i < count; i++) {
+      duckdb::DuckLakeTag tag;
+      tag.key = String();
+      tag.value = String();
+      tags.push_back(std::move(tag));
+    }
+    return tags;
+  }
+
+  duckdb::DuckLakeColumnInfo Column() {
+    duckdb::DuckLakeColumnInfo column;
+    column.id = duckdb::FieldIndex(Idx());
+    column.name = String();
+    column.type = String();
+    column.initial_default = OptionalString();
+    column.default_value = OptionalString();
+    column.nulls_allowed = Bool();
+    column.tags = Tags();
+    idx_t count = Count();
+    for (idx_t i = 0; i < count; i++) {
+      column.children.push_back(Column());
+    }
+    return column;
+  }
+
+  // An element count; a corrupt one must not make us loop for long
+  idx_t Count() {
+    idx_t count = Idx();
+    if (count > size - pos) {
+      ok = false;
+      return 0;
+    }
+    return count;
+  }
+
+  bool IsValid() const { return ok && pos == size; }
+
+private:
+  bool Check(size_t len) {
+    if (!ok || len > size - pos) {
+      ok = false;
+      return false;
+    }
+    return true;
+  }
+
+  const char *data;
+  size_t size;
+  size_t pos = 0;
+  bool ok = true;
+};
+
+static idx_t GetIndex(idx_t value) { return value; }
+static idx_t GetIndex(const duckdb::optional_idx &value) {
+  return value.GetIndex();
+}
+
+static duckdb::string
+SerializeCatalog(const duckdb::string &data_path,
+                 const duckdb::DuckLakeCatalogInfo &catalog) {
+  CatalogWriter writer;
+  writer.Idx(CATALOG_FORMAT_VERSION);
+  writer.String(data_path);
+
+  writer.Idx(catalog.schemas.size());
+  for (auto &schema : catalog.schemas) {
+    writer.Idx(schema.id.index);
+    writer.String(schema.uuid);
+    writer.String(schema.name);
+    writer.String(schema.path);
+  }
+
+  writer.Idx(catalog.tables.size());
+  for (auto &table : catalog.tables) {
+    writer.Idx(table.id.index);
+    writer.Idx(table.schema_id.index);
+    writer.String(table.uuid);
+    writer.String(table.name);
+    writer.String(table.path);
+    writer.Tags(table.tags);
+    writer.Idx(table.inlined_data_tables.size());
+    for (auto &inlined : table.inlined_data_tables) {
+      writer.String(inlined.table_name);
+      writer.Idx(inlined.schema_version);
+    }
+    writer.Idx(table.columns.size());
+    for (auto &column : table.columns) {
+      writer.Column(column);
+    }
+  }
+
+  writer.Idx(catalog.views.size());
+  for (auto &view : catalog.views) {
+    writer.Idx(view.id.index);
+    writer.Idx(view.schema_id.index);
+    writer.String(view.uuid);
+    writer.String(view.name);
+    writer.String(view.dialect);
+    writer.String(view.sql);
+    writer.Idx(view.column_aliases.size());
+    for (auto &alias : view.column_aliases) {
+      writer.String(alias);
+    }
+    writer.Tags(view.tags);
+  }
+
+  writer.Idx(catalog.partitions.size());
+  for (auto &partition : catalog.partitions) {
+    writer.Idx(GetIndex(partition.id));
+    writer.Idx(partition.table_id.index);
+    writer.Idx(partition.fields.size());
+    for (auto &field : partition.fields) {
+      writer.Idx(field.partition_key_index);
+      writer.Idx(field.field_id.index);
+      writer.String(field.transform);
+    }
+  }
+  return std::move(writer.buffer);
+}
+
+static bool DeserializeCatalog(const char *data, size_t size,
+                               const duckdb::string &data_path,
+                               duckdb::DuckLakeCatalogInfo &catalog) {
+  CatalogReader reader(data, size);
+  if (reader.Idx() != CATALOG_FORMAT_VERSION ||
+      reader.String() != data_path) {
+    return false;
+  }
+
+  idx_t count = reader.Count();
+  for (idx_t i = 0; i < count; i++) {
+    duckdb::DuckLakeSchemaInfo schema;
+    schema.id = duckdb::SchemaIndex(reader.Idx());
+    schema.uuid = reader.String();
+    schema.name = reader.String();
+    schema.path = reader.String();
+    catalog.schemas.push_back(std::move(schema));
+  }
+
+  count = reader.Count();
+  for (idx_t i = 0; i < count; i++) {
+    duckdb::DuckLakeTableInfo table;
+    table.id = duckdb::TableIndex(reader.Idx());
+    table.schema_id = duckdb::SchemaIndex(reader.Idx());
+    table.uuid = reader.String();
+    table.name = reader.String();
+    table.path = reader.String();
+    table.tags = reader.Tags();
+    idx_t inlined_count = reader.Count();
+    for (idx_t j = 0; j < inlined_count; j++) {
+      duckdb::DuckLakeInlinedTableInfo inlined;
+      inlined.table_name = reader.String();
+      inlined.schema_version = reader.Idx();
+      table.inlined_data_tables.push_back(std::move(inlined));
+    }
+    idx_t column_count = reader.Count();
+    for (idx_t j = 0; j < column_count; j++) {
+      table.columns.push_back(reader.Column());
+    }
+    catalog.tables.push_back(std::move(table));
+  }
+
+  count = reader.Count();
+  for (idx_t i = 0; i < count; i++) {
+    duckdb::DuckLakeViewInfo view;
+    view.id = duckdb::TableIndex(reader.Idx());
+    view.schema_id = duckdb::SchemaIndex(reader.Idx());
+    view.uuid = reader.String();
+    view.name = reader.String();
+    view.dialect = reader.String();
+    view.sql = reader.String();
+    idx_t alias_count = reader.Count();
+    for (idx_t j = 0; j < alias_count; j++) {
+      view.column_aliases.push_back(reader.String());
+    }
+    view.tags = reader.Tags();
+    catalog.views.push_back(std::move(view));
+  }
+
+  count = reader.Count();
+  for (idx_t i = 0; i < count; i++) {
+    duckdb::DuckLakePartitionInfo partition;
+    partition.id = reader.Idx();
+    partition.table_id = duckdb::TableIndex(reader.Idx());
+    idx_t field_count = reader.Count();
+    for (idx_t j = 0; j < field_count; j++) {
+      duckdb::DuckLakePartitionFieldInfo field;
+      field.partition_key_index = reader.Idx();
+      field.field_id = duckdb::FieldIndex(reader.Idx());
+      field.transform = reader.String();
+      partition.fields.push_back(std::move(field));
+    }
+    catalog.partitions.push_back(std::move(partition));
+  }
+
+  return reader.IsValid();
+}
+
+//------------------------------------------------------------------------------
+// Shared memory arena
+//------------------------------------------------------------------------------
+
+// Catalogs are kept back to back in the arena, each taking the room it
+// needs; this bounds how many are kept at once.
+constexpr int SHARED_CATALOG_CACHE_ENTRIES = 64;
+
+struct SharedCatalogEntry {
+  bool valid;
+  Oid dboid;
+  Oid snapshot_relid;
+  uint64 snapshot_id;
+  uint32 data_path_hash;
+  // Value of the use clock at the last hit, for LRU replacement
+  pg_atomic_uint64 last_used;
+  // Where the serialized catalog is in the arena
+  Size offset;
+  Size size;
+};
+
+struct SharedCatalogCacheState {
+  LWLock *lock;
+  pg_atomic_uint64 use_clock;
+  pg_atomic_uint64 hits;
+  pg_atomic_uint64 misses;
+  pg_atomic_uint64 stores;
+  // Catalogs not stored because they are larger than the whole arena
+  pg_atomic_uint64 skipped_stores;
+  Size arena_size;
+  SharedCatalogEntry entries[SHARED_CATALOG_CACHE_ENTRIES];
+  // Followed by the arena, arena_size bytes
+};
+
+// In kB, as set at postmaster start; 0 disables the cache
+static int shared_catalog_cache_size = 16384;
+
+static SharedCatalogCacheState *shared_state = nullptr;
+static shmem_startup_hook_type prev_shmem_startup_hook = nullptr;
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = nullptr;
+#endif
+
+static Size SharedCatalogCacheShmemSize() {
+  return add_size(MAXALIGN(sizeof(SharedCatalogCacheState)),
+                  mul_size(shared_catalog_cache_size, 1024));
+}
+
+static char *ArenaData() {
+  return reinterpret_cast<char *>(shared_state) +
+         MAXALIGN(sizeof(SharedCatalogCacheState));
+}
+
+static void SharedCatalogCacheShmemRequest() {
+#if PG_VERSION_NUM >= 150000
+  if (prev_shmem_request_hook) {
+    prev_shmem_request_hook();
+  }
+#endif
+  RequestAddinShmemSpace(SharedCatalogCacheShmemSize());
+  RequestNamedLWLockTranche("pg_ducklake_catalog_cache", 1);
+}
+
+static void SharedCatalogCacheShmemStartup() {
+  if (prev_shmem_startup_hook) {
+    prev_shmem_startup_hook();
+  }
+
+  LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+  bool found;
+  shared_state = static_cast<SharedCatalogCacheState *>(
+      ShmemInitStruct("pg_ducklake catalog cache",
+                      SharedCatalogCacheShmemSize(), &found));
+  if (!found) {
+    shared_state->lock =
+        &(GetNamedLWLockTranche("pg_ducklake_catalog_cache"))->lock;
+    pg_atomic_init_u64(&shared_state->use_clock, 0);
+    pg_atomic_init_u64(&shared_state->hits, 0);
+    pg_atomic_init_u64(&shared_state->misses, 0);
+    pg_atomic_init_u64(&shared_state->stores, 0);
+    pg_atomic_init_u64(&shared_state->skipped_stores, 0);
+    shared_state->arena_size =
+        static_cast<Size>(shared_catalog_cache_size) * 1024;
+    for (auto &entry : shared_state->entries) {
+      entry.valid = false;
+      pg_atomic_init_u64(&entry.last_used, 0);
+    }
+  }
+  LWLockRelease(AddinShmemInitLock);
+}
+
+static uint32 HashDataPath(const duckdb::string &data_path) {
+  return hash_bytes(reinterpret_cast<const unsigned char *>(data_path.data()),
+                    static_cast<int>(data_path.size()));
+}
+
+static bool EntryMatches(const SharedCatalogEntry &entry, Oid snapshot_relid,
+                         idx_t snapshot_id, uint32 data_path_hash) {
+  return entry.valid && entry.dboid == MyDatabaseId &&
+         entry.snapshot_relid == snapshot_relid &&
+         entry.snapshot_id == snapshot_id &&
+         entry.data_path_hash == data_path_hash;
+}
+
+/*
+ * Find `size` free bytes in the arena for a new catalog, moving the catalogs
+ * kept to its start when the free room is only there in pieces. False if
+ * there is not enough free room in total. Must hold the lock exclusively.
+ */
+static bool FindRoom(Size size, Size &offset) {
+  int order[SHARED_CATALOG_CACHE_ENTRIES];
+  int count = 0;
+  Size used = 0;
+  for (int i = 0; i < SHARED_CATALOG_CACHE_ENTRIES; i++) {
+    if (shared_state->entries[i].valid) {
+      order[count++] = i;
+      used += shared_state->entries[i].size;
+    }
+  }
+  if (size > shared_state->arena_size - used) {
+    return false;
+  }
+  std::sort(order, order + count, [](int a, int b) {
+    return shared_state->entries[a].offset < shared_state->entries[b].offset;
+  });
+
+  // The first gap large enough, if any
+  Size end = 0;
+  for (int i = 0; i < count; i++) {
+    auto &entry = shared_state->entries[order[i]];
+    if (entry.offset - end >= size) {
+      offset = end;
+      return true;
+    }
+    end = entry.offset + entry.size;
+  }
+  if (shared_state->arena_size - end >= size) {
+    offset = end;
+    return true;
+  }
+
+  // Otherwise pack the catalogs together, leaving the free room at the end
+  end = 0;
+  for (int i = 0; i < count; i++) {
+    auto &entry = shared_state->entries[order[i]];
+    if (entry.offset != end) {
+      memmove(ArenaData() + end, ArenaData() + entry.offset, entry.size);
+      entry.offset = end;
+    }
+    end += entry.size;
+  }
+  offset = end;
+  return true;
+}
+
+bool SharedCatalogCache::IsEnabled() { return shared_state != nullptr; }
+
+bool SharedCatalogCache::Lookup(Oid snapshot_relid, idx_t snapshot_id,
+                                const duckdb::string &data_path,
+                                duckdb::DuckLakeCatalogInfo &catalog) {
+  if (!IsEnabled()) {
+    return false;
+  }
+
+  uint32 data_path_hash = HashDataPath(data_path);
+  duckdb::string data;
+  bool found = false;
+
+  // Copy the entry out, so the lock is not held while decoding it
+  LWLockAcquire(shared_state->lock, LW_SHARED);
+  for (auto &entry : shared_state->entries) {
+    if (EntryMatches(entry, snapshot_relid, snapshot_id, data_path_hash)) {
+      data.assign(ArenaData() + entry.offset, entry.size);
+      pg_atomic_write_u64(&entry.last_used,
+                          pg_atomic_add_fetch_u64(&shared_state->use_clock, 1));
+      found = true;
+      break;
+    }
+  }
+  LWLockRelease(shared_state->lock);
+
+  if (found) {
+    duckdb::DuckLakeCatalogInfo decoded;
+    found = DeserializeCatalog(data.data(), data.size(), data_path, decoded);
+    if (found) {
+      catalog = std::move(decoded);
+    }
+  }
+  pg_atomic_fetch_add_u64(found ? &shared_state->hits : &shared_state->misses,
+                          1);
+  return found;
+}
+
+void SharedCatalogCache::Store(Oid snapshot_relid, idx_t snapshot_id,
+                               const duckdb::string &data_path,
+                               const duckdb::DuckLakeCatalogInfo &catalog) {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  auto data = SerializeCatalog(data_path, catalog);
+  if (data.size() > shared_state->arena_size) {
+    pg_atomic_fetch_add_u64(&shared_state->skipped_stores, 1);
+    return;
+  }
+  uint32 data_path_hash = HashDataPath(data_path);
+
+  LWLockAcquire(shared_state->lock, LW_EXCLUSIVE);
+  for (auto &entry : shared_state->entries) {
+    if (EntryMatches(entry, snapshot_relid, snapshot_id, data_path_hash)) {
+      // Another backend got there first
+      LWLockRelease(shared_state->lock);
+      return;
+    }
+  }
+
+  // Drop the least recently used catalogs until there is an entry free and
+  // room for this one; with all of them gone there is.
+  SharedCatalogEntry *target = nullptr;
+  Size offset = 0;
+  for (;;) {
+    SharedCatalogEntry *victim = nullptr;
+    target = nullptr;
+    for (auto &entry : shared_state->entries) {
+      if (!entry.valid) {
+        target = target ? target : &entry;
+      } else if (!victim || pg_atomic_read_u64(&entry.last_used) <
+                                pg_atomic_read_u64(&victim->last_used)) {
+        victim = &entry;
+      }
+    }
+    if (target && FindRoom(data.size(), offset)) {
+      break;
+    }
+    victim->valid = false;
+  }
+
+  memcpy(ArenaData() + offset, data.data(), data.size());
+  target->valid = true;
+  target->dboid = MyDatabaseId;
+  target->snapshot_relid = snapshot_relid;
+  target->snapshot_id = snapshot_id;
+  target->data_path_hash = data_path_hash;
+  target->offset = offset;
+  target->size = data.size();
+  pg_atomic_write_u64(&target->last_used,
+                      pg_atomic_add_fetch_u64(&shared_state->use_clock, 1));
+  pg_atomic_fetch_add_u64(&shared_state->stores, 1);
+  LWLockRelease(shared_state->lock);
+}
+
+} // namespace pgducklake
+
+extern "C" {
+
+void ducklake_init_shared_catalog_cache(void) {
+  DefineCustomIntVariable(
+      "ducklake.shared_catalog_cache_size",
+      "Size of the shared memory cache of DuckLake catalogs.",
+      "Only used when pg_ducklake is in shared_preload_libraries. 0 disables "
+      "the cache.",
+      &pgducklake::shared_catalog_cache_size, 16384, 0, INT_MAX / 1024,
+      PGC_POSTMASTER, GUC_UNIT_KB, NULL, NULL, NULL);
+
+  if (!process_shared_preload_libraries_in_progress ||
+      pgducklake::shared_catalog_cache_size == 0) {
+    return;
+  }
+
+#if PG_VERSION_NUM >= 150000
+  pgducklake::prev_shmem_request_hook = shmem_request_hook;
+  shmem_request_hook = pgducklake::SharedCatalogCacheShmemRequest;
+#else
+  pgducklake::SharedCatalogCacheShmemRequest();
+#endif
+  pgducklake::prev_shmem_startup_hook = shmem_startup_hook;
+  shmem_startup_hook = pgducklake::SharedCatalogCacheShmemStartup;
+}
+
+/*
+ * ducklake_catalog_cache_stats() - Counters of the shared catalog cache since
+ * postmaster start, for the ducklake.catalog_cache_stats view.
+ */
+DECLARE_PG_FUNCTION(ducklake_catalog_cache_stats) {
+  using pgducklake::shared_state;
+
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+
+  Datum values[6];
+  bool nulls[6] = {false, false, false, false, false, false};
+  int entries = 0;
+  values[0] = BoolGetDatum(shared_state != nullptr);
+  if (shared_state) {
+    values[1] = Int64GetDatum(pg_atomic_read_u64(&shared_state->hits));
+    values[2] = Int64GetDatum(pg_atomic_read_u64(&shared_state->misses));
+    values[3] = Int64GetDatum(pg_atomic_read_u64(&shared_state->stores));
+    values[4] =
+        Int64GetDatum(pg_atomic_read_u64(&shared_state->skipped_stores));
+    LWLockAcquire(shared_state->lock, LW_SHARED);
+    for (auto &entry : shared_state->entries) {
+      entries += entry.valid ? 1 : 0;
+    }
+    LWLockRelease(shared_state->lock);
+  } else {
+    values[1] = values[2] = values[3] = values[4] = Int64GetDatum(0);
+  }
+  values[5] = Int32GetDatum(entries);
+
+  PG_RETURN_DATUM(
+      HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+} // extern "C"
@@ -0,0 +1,406 @@
+#include "pgducklake/pgducklake_shared_snapshot.hpp"
+
+#include "pgducklake/pgducklake_metadata_scan.hpp"
+#include "pgducklake/pgducklake_spi.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_type.h"
+#include "commands/trigger.h"
+#include "executor/spi.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+}
+
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include <cstring>
+
+namespace pgducklake {
+
+// One per DuckLake catalog, i.e. per database with the extension
+constexpr int SHARED_SNAPSHOT_SLOTS = 32;
+
+struct SharedSnapshotSlot {
+  Oid dboid;
+  Oid snapshot_relid;
+  // Transactions that wrote a snapshot of this catalog and did not publish it
+  // (or abort) yet
+  int in_flight;
+  // Set when a prepared transaction wrote a snapshot: it commits without us
+  // noticing, so nothing published for this catalog can be trusted anymore
+  bool disabled;
+  bool valid;
+  // The transaction that wrote the snapshot
+  TransactionId xid;
+  uint64 snapshot_id;
+  uint64 schema_version;
+  uint64 next_catalog_id;
+  uint64 next_file_id;
+};
+
+struct SharedSnapshotState {
+  slock_t mutex;
+  // Transactions in flight that found no slot for their catalog. Nothing is
+  // published or used while there are any.
+  int untracked_in_flight;
+  // Commits (and prepares) of transactions that wrote a snapshot, of any
+  // catalog
+  uint64 commits;
+  SharedSnapshotSlot slots[SHARED_SNAPSHOT_SLOTS];
+};
+
+static SharedSnapshotState *shared_snapshot = nullptr;
+static shmem_startup_hook_type prev_shmem_startup_hook = nullptr;
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = nullptr;
+#endif
+
+static void SharedSnapshotShmemRequest() {
+#if PG_VERSION_NUM >= 150000
+  if (prev_shmem_request_hook) {
+    prev_shmem_request_hook();
+  }
+#endif
+  RequestAddinShmemSpace(MAXALIGN(sizeof(SharedSnapshotState)));
+}
+
+static void SharedSnapshotShmemStartup() {
+  if (prev_shmem_startup_hook) {
+    prev_shmem_startup_hook();
+  }
+
+  LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+  bool found;
+  shared_snapshot = static_cast<SharedSnapshotState *>(ShmemInitStruct(
+      "pg_ducklake latest snapshot", sizeof(SharedSnapshotState), &found));
+  if (!found) {
+    SpinLockInit(&shared_snapshot->mutex);
+    shared_snapshot->untracked_in_flight = 0;
+    shared_snapshot->commits = 0;
+    memset(shared_snapshot->slots, 0, sizeof(shared_snapshot->slots));
+  }
+  LWLockRelease(AddinShmemInitLock);
+}
+
+static Oid SnapshotRelid() {
+  Oid nspoid = get_namespace_oid("ducklake", true);
+  if (!OidIsValid(nspoid)) {
+    return InvalidOid;
+  }
+  return get_relname_relid("ducklake_snapshot", nspoid);
+}
+
+// The slot of the catalog of `snapshot_relid`, optionally taking over a free
+// one, or else one of another catalog with nothing in flight, if there is
+// none. Must hold the mutex.
+static SharedSnapshotSlot *FindSlot(Oid snapshot_relid, bool claim) {
+  SharedSnapshotSlot *victim = nullptr;
+  for (auto &slot : shared_snapshot->slots) {
+    if (slot.dboid == MyDatabaseId && slot.snapshot_relid == snapshot_relid) {
+      return &slot;
+    }
+    if (slot.in_flight > 0 || slot.disabled) {
+      continue;
+    }
+    if (!OidIsValid(slot.dboid) || !victim) {
+      victim = &slot;
+    }
+  }
+  if (!claim || !victim) {
+    return nullptr;
+  }
+  memset(victim, 0, sizeof(*victim));
+  victim->dboid = MyDatabaseId;
+  victim->snapshot_relid = snapshot_relid;
+  return victim;
+}
+
+static void SetSlotSnapshot(SharedSnapshotSlot &slot,
+                            const duckdb::DuckLakeSnapshot &snapshot,
+                            TransactionId xid) {
+  slot.valid = true;
+  slot.xid = xid;
+  slot.snapshot_id = snapshot.snapshot_id;
+  slot.schema_version = snapshot.schema_version;
+  slot.next_catalog_id = snapshot.next_catalog_id;
+  slot.next_file_id = snapshot.next_file_id;
+}
+
+/*
+ * Snapshot written by the current transaction, published at commit. Its slot
+ * (or the untracked count, if it got none) counts the transaction as in
+ * flight from the first write on. It becomes uncertain if a subtransaction
+ * that wrote it aborts, in which case the slot is reset at commit rather than
+ * published.
+ */
+static bool pending = false;
+static Oid pending_relid = InvalidOid;
+static SharedSnapshotSlot *pending_slot = nullptr;
+static duckdb::DuckLakeSnapshot pending_snapshot(0, 0, 0, 0);
+// Saved at the first write: it is gone by the time of the COMMIT event
+static TransactionId pending_xid = InvalidTransactionId;
+static int pending_nest_level = 0;
+static bool pending_uncertain = false;
+
+static void SharedSnapshotXactCallback(XactEvent event, void * /*arg*/) {
+  if (!pending) {
+    return;
+  }
+  bool commit;
+  switch (event) {
+  case XACT_EVENT_COMMIT:
+  case XACT_EVENT_PARALLEL_COMMIT:
+    commit = true;
+    break;
+  case XACT_EVENT_ABORT:
+  case XACT_EVENT_PARALLEL_ABORT:
+  case XACT_EVENT_PREPARE:
+    commit = false;
+    break;
+  default:
+    return;
+  }
+
+  SpinLockAcquire(&shared_snapshot->mutex);
+  if (commit || event == XACT_EVENT_PREPARE) {
+    shared_snapshot->commits++;
+  }
+  if (!pending_slot) {
+    shared_snapshot->untracked_in_flight--;
+    // A slot may have been claimed for the catalog in the meantime
+    SharedSnapshotSlot *slot = FindSlot(pending_relid, false);
+    if (slot && event == XACT_EVENT_PREPARE) {
+      slot->disabled = true;
+    }
+    if (slot && (commit || event == XACT_EVENT_PREPARE)) {
+      slot->valid = false;
+    }
+  } else {
+    auto &slot = *pending_slot;
+    slot.in_flight--;
+    if (event == XACT_EVENT_PREPARE) {
+      slot.disabled = true;
+      slot.valid = false;
+    } else if (commit && pending_uncertain) {
+      slot.valid = false;
+    } else if (commit && !slot.disabled &&
+               (!slot.valid ||
+                pending_snapshot.snapshot_id > slot.snapshot_id)) {
+      SetSlotSnapshot(slot, pending_snapshot, pending_xid);
+    }
+  }
+  SpinLockRelease(&shared_snapshot->mutex);
+  pending = false;
+  pending_slot = nullptr;
+  pending_uncertain = false;
+}
+
+static void SharedSnapshotSubXactCallback(SubXactEvent event,
+                                          SubTransactionId /*my_subid*/,
+                                          SubTransactionId /*parent_subid*/,
+                                          void * /*arg*/) {
+  if (pending && event == SUBXACT_EVENT_ABORT_SUB &&
+      GetCurrentTransactionNestLevel() <= pending_nest_level) {
+    pending_uncertain = true;
+  }
+}
+
+// Note that the current transaction wrote `snapshot` into the ducklake_snapshot
+// table `snapshot_relid`.
+static void NoteSnapshotWritten(Oid snapshot_relid,
+                                const duckdb::DuckLakeSnapshot &snapshot) {
+  static bool callbacks_registered = false;
+  if (!callbacks_registered) {
+    RegisterXactCallback(SharedSnapshotXactCallback, nullptr);
+    RegisterSubXactCallback(SharedSnapshotSubXactCallback, nullptr);
+    callbacks_registered = true;
+  }
+
+  if (pending) {
+    if (snapshot.snapshot_id > pending_snapshot.snapshot_id) {
+      pending_snapshot = snapshot;
+    }
+    pending_nest_level =
+        Min(pending_nest_level, GetCurrentTransactionNestLevel());
+    return;
+  }
+
+  SpinLockAcquire(&shared_snapshot->mutex);
+  SharedSnapshotSlot *slot = FindSlot(snapshot_relid, true);
+  if (slot) {
+    slot->in_flight++;
+  } else {
+    shared_snapshot->untracked_in_flight++;
+  }
+  SpinLockRelease(&shared_snapshot->mutex);
+  pending = true;
+  pending_relid = snapshot_relid;
+  pending_slot = slot;
+  pending_snapshot = snapshot;
+  pending_xid = GetTopTransactionId();
+  pending_nest_level = GetCurrentTransactionNestLevel();
+  pending_uncertain = false;
+}
+
+bool SharedLatestSnapshot::IsEnabled() { return shared_snapshot != nullptr; }
+
+/*
+ * Fill the empty slot of the catalog of `snapshot_relid` from ducklake_snapshot
+ * as of now, unless a transaction that wrote a snapshot committed since
+ * `commits` was read, which the scan may or may not have seen.
+ */
+static bool SeedSlot(Oid snapshot_relid, uint64 commits,
+                     SharedSnapshotSlot &copy) {
+  duckdb::DuckLakeSnapshot snapshot(0, 0, 0, 0);
+  TransactionId xmin;
+  if (!ScanLatestCommittedSnapshot(snapshot, xmin)) {
+    return false;
+  }
+
+  bool found = false;
+  SpinLockAcquire(&shared_snapshot->mutex);
+  if (shared_snapshot->commits == commits &&
+      shared_snapshot->untracked_in_flight == 0) {
+    SharedSnapshotSlot *slot = FindSlot(snapshot_relid, true);
+    if (slot && !slot->valid && !slot->disabled && slot->in_flight == 0) {
+      SetSlotSnapshot(*slot, snapshot, xmin);
+    }
+    if (slot) {
+      copy = *slot;
+      found = copy.valid;
+    }
+  }
+  SpinLockRelease(&shared_snapshot->mutex);
+  return found;
+}
+
+bool SharedLatestSnapshot::Lookup(duckdb::DuckLakeSnapshot &snapshot) {
+  // A transaction that wrote metadata may see its own, uncommitted snapshot
+  if (!IsEnabled() || TransactionIdIsValid(GetTopTransactionIdIfAny())) {
+    return false;
+  }
+  Oid relid = SnapshotRelid();
+  if (!OidIsValid(relid)) {
+    return false;
+  }
+
+  SharedSnapshotSlot copy;
+  bool found = false;
+  bool seed = false;
+  uint64 commits = 0;
+  SpinLockAcquire(&shared_snapshot->mutex);
+  if (shared_snapshot->untracked_in_flight == 0) {
+    SharedSnapshotSlot *slot = FindSlot(relid, false);
+    if (slot && slot->valid) {
+      copy = *slot;
+      found = true;
+    } else {
+      seed = !slot || (!slot->disabled && slot->in_flight == 0);
+      commits = shared_snapshot->commits;
+    }
+  }
+  SpinLockRelease(&shared_snapshot->mutex);
+
+  if (seed) {
+    found = SeedSlot(relid, commits, copy);
+  }
+  if (!found || copy.disabled || copy.in_flight > 0) {
+    return false;
+  }
+  // Committed after this transaction's snapshot was taken: its metadata reads
+  // would not see the snapshot yet
+  if (XidInMVCCSnapshot(copy.xid, GetMetadataReadSnapshot())) {
+    return false;
+  }
+  snapshot = duckdb::DuckLakeSnapshot(copy.snapshot_id, copy.schema_version,
+                                      copy.next_catalog_id, copy.next_file_id);
+  return true;
+}
+
+static uint64 GetSnapshotColumn(Relation rel, HeapTuple tuple,
+                                const char *name) {
+  TupleDesc tupdesc = RelationGetDescr(rel);
+  int attnum = SPI_fnumber(tupdesc, name);
+  if (attnum <= 0) {
+    elog(ERROR, "DuckLake metadata table \"%s\" has no column \"%s\"",
+         RelationGetRelationName(rel), name);
+  }
+  bool isnull;
+  Datum value = SPI_getbinval(tuple, tupdesc, attnum, &isnull);
+  if (isnull) {
+    return 0;
+  }
+  switch (TupleDescAttr(tupdesc, attnum - 1)->atttypid) {
+  case INT8OID:
+    return DatumGetInt64(value);
+  case INT4OID:
+    return DatumGetInt32(value);
+  default:
+    elog(ERROR, "unexpected type of DuckLake metadata column %s.%s",
+         RelationGetRelationName(rel), name);
+    pg_unreachable();
+  }
+}
+
+} // namespace pgducklake
+
+extern "C" {
+
+void ducklake_init_shared_latest_snapshot(void) {
+  if (!process_shared_preload_libraries_in_progress) {
+    return;
+  }
+
+#if PG_VERSION_NUM >= 150000
+  pgducklake::prev_shmem_request_hook = shmem_request_hook;
+  shmem_request_hook = pgducklake::SharedSnapshotShmemRequest;
+#else
+  pgducklake::SharedSnapshotShmemRequest();
+#endif
+  pgducklake::prev_shmem_startup_hook = shmem_startup_hook;
+  shmem_startup_hook = pgducklake::SharedSnapshotShmemStartup;
+}
+
+/*
+ * ducklake_snapshot_written() - AFTER INSERT row trigger on
+ * ducklake.ducklake_snapshot, noting the new snapshot for publication at
+ * commit.
+ */
+DECLARE_PG_FUNCTION(ducklake_snapshot_written) {
+  if (!CALLED_AS_TRIGGER(fcinfo)) /* internal error */
+    elog(ERROR, "not fired by trigger manager");
+
+  TriggerData *trigger_data = (TriggerData *)fcinfo->context;
+  if (!TRIGGER_FIRED_AFTER(trigger_data->tg_event) ||
+      !TRIGGER_FIRED_FOR_ROW(trigger_data->tg_event) ||
+      !TRIGGER_FIRED_BY_INSERT(trigger_data->tg_event)) {
+    elog(ERROR, "ducklake_snapshot_written() must be fired AFTER INSERT FOR "
+                "EACH ROW");
+  }
+
+  if (pgducklake::SharedLatestSnapshot::IsEnabled()) {
+    Relation rel = trigger_data->tg_relation;
+    HeapTuple tuple = trigger_data->tg_trigtuple;
+    duckdb::DuckLakeSnapshot snapshot(
+        pgducklake::GetSnapshotColumn(rel, tuple, "snapshot_id"),
+        pgducklake::GetSnapshotColumn(rel, tuple, "schema_version"),
+        pgducklake::GetSnapshotColumn(rel, tuple, "next_catalog_id"),
+        pgducklake::GetSnapshotColumn(rel, tuple, "next_file_id"));
+    pgducklake::NoteSnapshotWritten(RelationGetRelid(rel), snapshot);
+  }
+  return PointerGetDatum(NULL);
+}
+
+} // extern "C"
@@ -0,0 +1,733 @@
+#include "pgducklake/pgducklake_spi.hpp"
+
+// DuckDB headers first
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/common/enums/statement_type.hpp"
+#include "duckdb/common/types.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/main/materialized_query_result.hpp"
+
+// Our vendored type conversion utilities
+#include "pgducklake/pgducklake_pg_types.hpp"
+
+// PostgreSQL headers
+extern "C" {
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "executor/spi.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/elog.h"
+#include "utils/guc.h"
+#include "utils/plancache.h"
+#include "utils/portal.h"
+#include "utils/resowner.h"
+#include "utils/snapmgr.h"
+#include "utils/tuplestore.h"
+}
+
+// Include after PostgreSQL headers (since these also include postgres.h)
+#include "pgducklake/utility/cpp_wrapper.hpp"
+#include "pgducklake/utility/unsafe_command_id_guard.hpp"
+#include <cctype>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+namespace pgducklake {
+
+static const char *const SNAPSHOT_PLACEHOLDERS[] = {
+    "{SNAPSHOT_ID}", "{SCHEMA_VERSION}", "{NEXT_CATALOG_ID}", "{NEXT_FILE_ID}"};
+
+SnapshotParams::SnapshotParams(const duckdb::DuckLakeSnapshot &snapshot)
+    : num_params(NUM_SNAPSHOT_PARAMS) {
+  for (int i = 0; i < NUM_SNAPSHOT_PARAMS; i++) {
+    types[i] = INT8OID;
+  }
+  values[0] = Int64GetDatum(static_cast<int64>(snapshot.snapshot_id));
+  values[1] = Int64GetDatum(static_cast<int64>(snapshot.schema_version));
+  values[2] = Int64GetDatum(static_cast<int64>(snapshot.next_catalog_id));
+  values[3] = Int64GetDatum(static_cast<int64>(snapshot.next_file_id));
+}
+
+duckdb::string SnapshotParams::AddBigint(int64 value) {
+  if (num_params >= NUM_SNAPSHOT_PARAMS + MAX_EXTRA_PARAMS) {
+    elog(ERROR, "too many metadata query parameters");
+  }
+  types[num_params] = INT8OID;
+  values[num_params] = Int64GetDatum(value);
+  return "$" + std::to_string(++num_params);
+}
+
+duckdb::string SnapshotParams::AddBigintArray(const duckdb::set<idx_t> &ids) {
+  if (num_params >= NUM_SNAPSHOT_PARAMS + MAX_EXTRA_PARAMS) {
+    elog(ERROR, "too many metadata query parameters");
+  }
+  Datum *elems = static_cast<Datum *>(palloc(sizeof(Datum) * ids.size()));
+  int n = 0;
+  for (auto id : ids) {
+    elems[n++] = Int64GetDatum(static_cast<int64>(id));
+  }
+  types[num_params] = INT8ARRAYOID;
+  values[num_params] = PointerGetDatum(construct_array(
+      elems, n, INT8OID, sizeof(int64), FLOAT8PASSBYVAL, TYPALIGN_DOUBLE));
+  return "$" + std::to_string(++num_params);
+}
+
+bool IsSelectQuery(const duckdb::string &query) {
+  idx_t pos = 0;
+  while (pos < query.size() && isspace(static_cast<unsigned char>(query[pos]))) {
+    pos++;
+  }
+  return pg_strncasecmp(query.c_str() + pos, "SELECT", 6) == 0 ||
+         pg_strncasecmp(query.c_str() + pos, "WITH", 4) == 0;
+}
+
+bool ParameterizeSnapshotArgs(duckdb::string &query) {
+  duckdb::string result;
+  result.reserve(query.size());
+  bool in_single_quote = false;
+  bool in_double_quote = false;
+  bool replaced = false;
+
+  for (idx_t pos = 0; pos < query.size();) {
+    char c = query[pos];
+    if (c == '{') {
+      int param = -1;
+      for (int i = 0; i < NUM_SNAPSHOT_PARAMS; i++) {
+        if (query.compare(pos, strlen(SNAPSHOT_PLACEHOLDERS[i]),
+                          SNAPSHOT_PLACEHOLDERS[i]) == 0) {
+          param = i;
+          break;
+        }
+      }
+      if (param >= 0) {
+        if (in_single_quote || in_double_quote) {
+          return false;
+        }
+        result += "$" + std::to_string(param + 1);
+        pos += strlen(SNAPSHOT_PLACEHOLDERS[param]);
+        replaced = true;
+        continue;
+      }
+    } else if (c == '\'' && !in_double_quote) {
+      in_single_quote = !in_single_quote;
+    } else if (c == '"' && !in_single_quote) {
+      in_double_quote = !in_double_quote;
+    }
+    result += c;
+    pos++;
+  }
+
+  if (!replaced) {
+    return false;
+  }
+  query = std::move(result);
+  return true;
+}
+
+/*
+ * Per-backend cache of prepared plans, keyed by the final query text, with or
+ * without parameters, and evicted in LRU order. Plans are kept with
+ * SPI_keepplan, so the plan cache revalidates them when the metadata tables
+ * change underneath.
+ */
+constexpr size_t PLAN_CACHE_MAX_ENTRIES = 256;
+
+using PlanCacheList = std::list<std::pair<duckdb::string, SPIPlanPtr>>;
+static PlanCacheList plan_cache_lru;
+static std::unordered_map<duckdb::string, PlanCacheList::iterator> plan_cache;
+
+// Reads run from a cached plan, and plans prepared, for
+// ducklake._plan_cache_stats()
+static int64 plan_cache_hits = 0;
+static int64 plan_cache_prepares = 0;
+
+static SPIPlanPtr GetCachedPlan(const duckdb::string &query, int nargs,
+                                const Oid *types) {
+  auto entry = plan_cache.find(query);
+  if (entry != plan_cache.end()) {
+    SPIPlanPtr plan = entry->second->second;
+    if (SPI_getargcount(plan) == nargs) {
+      plan_cache_lru.splice(plan_cache_lru.begin(), plan_cache_lru,
+                            entry->second);
+      plan_cache_hits++;
+      return plan;
+    }
+    // The same text bound with other parameters
+    SPI_freeplan(plan);
+    plan_cache_lru.erase(entry->second);
+    plan_cache.erase(entry);
+  }
+
+  SPIPlanPtr plan =
+      SPI_prepare(query.c_str(), nargs, const_cast<Oid *>(types));
+  if (!plan) {
+    elog(ERROR, "SPI_prepare failed: %s", SPI_result_code_string(SPI_result));
+  }
+  SPI_keepplan(plan);
+  plan_cache_prepares++;
+
+  plan_cache_lru.emplace_front(query, plan);
+  plan_cache[query] = plan_cache_lru.begin();
+  if (plan_cache_lru.size() > PLAN_CACHE_MAX_ENTRIES) {
+    auto &oldest = plan_cache_lru.back();
+    SPI_freeplan(oldest.second);
+    plan_cache.erase(oldest.first);
+    plan_cache_lru.pop_back();
+  }
+  return plan;
+}
+
+static SPIPlanPtr GetCachedPlan(const duckdb::string &query,
+                                const SnapshotParams &params) {
+  return GetCachedPlan(query, params.num_params, params.types);
+}
+
+static duckdb::StatementType ConvertSPIResultToDuckStatementType(int result) {
+  switch (result) {
+  case SPI_OK_UTILITY:
+    return duckdb::StatementType::EXECUTE_STATEMENT;
+  case SPI_OK_SELECT:
+  case SPI_OK_SELINTO:
+    return duckdb::StatementType::SELECT_STATEMENT;
+  case SPI_OK_INSERT:
+  case SPI_OK_INSERT_RETURNING:
+    return duckdb::StatementType::INSERT_STATEMENT;
+  case SPI_OK_DELETE:
+  case SPI_OK_DELETE_RETURNING:
+    return duckdb::StatementType::DELETE_STATEMENT;
+  case SPI_OK_UPDATE:
+  case SPI_OK_UPDATE_RETURNING:
+    return duckdb::StatementType::UPDATE_STATEMENT;
+  default:
+    // For now, we should not use other types query in SPI.
+    return duckdb::StatementType::INVALID_STATEMENT;
+  }
+}
+
+/*
+ * Pick the conversion kernel and DuckDB type of every column. With
+ * `reference_strings`, converted strings point into the tuples, which must
+ * outlive the chunks they are converted into.
+ */
+static void
+DescribeTupleDesc(TupleDesc tupdesc,
+                  duckdb::vector<PostgresColumnConverter> &converters,
+                  duckdb::vector<duckdb::LogicalType> &types,
+                  duckdb::vector<duckdb::string> &names,
+                  bool reference_strings = false) {
+  for (int i = 0; i < tupdesc->natts; i++) {
+    Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+
+    D_ASSERT(!attr->attisdropped);
+
+    // Get column name
+    names.push_back(NameStr(attr->attname));
+
+    converters.emplace_back(attr, reference_strings);
+    types.push_back(converters.back().GetType());
+  }
+}
+
+/*
+ * Convert `num_tuples` rows of `tuptable`, starting at `start_idx`, into
+ * `output`. Each tuple is deformed once into all of its attributes, and the
+ * datums are laid out column by column so that every column is converted by
+ * its own kernel in one call. Tuples without a null bitmap skip the
+ * per-attribute null handling altogether.
+ */
+static void InsertSPITupleTableIntoChunk(
+    duckdb::DataChunk &output,
+    const duckdb::vector<PostgresColumnConverter> &converters,
+    SPITupleTable *tuptable, idx_t start_idx, idx_t num_tuples) {
+  D_ASSERT(tuptable);
+  D_ASSERT(start_idx + num_tuples <= tuptable->numvals);
+  D_ASSERT(num_tuples <= STANDARD_VECTOR_SIZE);
+
+  if (num_tuples == 0) {
+    return;
+  }
+
+  TupleDesc tupdesc = tuptable->tupdesc;
+  int natts = tupdesc->natts;
+  Datum *row_values = static_cast<Datum *>(palloc(natts * sizeof(Datum)));
+  bool *row_nulls = static_cast<bool *>(palloc(natts * sizeof(bool)));
+  Datum *values =
+      static_cast<Datum *>(palloc(natts * num_tuples * sizeof(Datum)));
+  bool *nulls = static_cast<bool *>(palloc0(natts * num_tuples * sizeof(bool)));
+
+  for (idx_t row = 0; row < num_tuples; row++) {
+    HeapTuple tuple = tuptable->vals[start_idx + row];
+    heap_deform_tuple(tuple, tupdesc, row_values, row_nulls);
+    bool has_nulls = HeapTupleHasNulls(tuple);
+
+    for (int col = 0; col < natts; col++) {
+      values[col * num_tuples + row] = row_values[col];
+      if (has_nulls && row_nulls[col]) {
+        nulls[col * num_tuples + row] = true;
+        duckdb::FlatVector::Validity(output.data[col]).SetInvalid(row);
+      }
+    }
+  }
+
+  for (int col = 0; col < natts; col++) {
+    converters[col].Convert(values + col * num_tuples,
+                            nulls + col * num_tuples, num_tuples,
+                            output.data[col]);
+  }
+
+  pfree(row_values);
+  pfree(row_nulls);
+  pfree(values);
+  pfree(nulls);
+}
+
+// Build the result of the last statement run through SPI. Must be called
+// before SPI_finish(), which frees the tuple table.
+static duckdb::unique_ptr<duckdb::QueryResult>
+MaterializeSPIResult(int ret, SPITupleTable *tuptable) {
+  if (!tuptable) {
+    // Return an empty result
+    duckdb::vector<duckdb::string> names;
+    duckdb::StatementProperties properties;
+    duckdb::ClientProperties client_properties;
+
+    // Create an empty ColumnDataCollection instead of passing nullptr
+    auto &allocator = duckdb::Allocator::DefaultAllocator();
+    auto empty_collection =
+        duckdb::make_uniq<duckdb::ColumnDataCollection>(allocator);
+
+    return duckdb::make_uniq<duckdb::MaterializedQueryResult>(
+        ConvertSPIResultToDuckStatementType(ret), properties, names,
+        std::move(empty_collection), client_properties);
+  }
+
+  uint64 num_rows = tuptable->numvals;
+
+  // Convert column types and names. Strings can point into the tuple table:
+  // every chunk is copied into the collection before the table is freed.
+  duckdb::vector<PostgresColumnConverter> converters;
+  duckdb::vector<duckdb::LogicalType> types;
+  duckdb::vector<duckdb::string> names;
+  DescribeTupleDesc(tuptable->tupdesc, converters, types, names, true);
+
+  // Create a ColumnDataCollection to store the results
+  duckdb::ClientProperties client_properties;
+  auto &allocator = duckdb::Allocator::DefaultAllocator();
+  auto collection_p =
+      duckdb::make_uniq<duckdb::ColumnDataCollection>(allocator, types);
+
+  // Convert SPI rows to DuckDB DataChunks and append them, reusing a single
+  // chunk for every batch
+  duckdb::DataChunk chunk;
+  chunk.Initialize(allocator, types);
+  for (idx_t row_idx = 0; row_idx < num_rows; row_idx += STANDARD_VECTOR_SIZE) {
+    idx_t chunk_size = duckdb::MinValue<idx_t>(STANDARD_VECTOR_SIZE,
+                                               num_rows - row_idx);
+    chunk.Reset();
+    InsertSPITupleTableIntoChunk(chunk, converters, tuptable, row_idx,
+                                 chunk_size);
+
+    chunk.SetCardinality(chunk_size);
+    collection_p->Append(chunk);
+  }
+
+  // Create and return the MaterializedQueryResult
+  duckdb::StatementProperties properties;
+  return duckdb::make_uniq<duckdb::MaterializedQueryResult>(
+      duckdb::StatementType::SELECT_STATEMENT, properties, names,
+      std::move(collection_p), client_properties);
+}
+
+duckdb::unique_ptr<duckdb::QueryResult> EmptySPIResult(int spi_result) {
+  return MaterializeSPIResult(spi_result, nullptr);
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteSPIQuery(const duckdb::string &query, const SnapshotParams *params) {
+  elog(DEBUG1, "Creating SPI result for query: %s", query.c_str());
+
+  PostgresScopedStackReset scoped_stack_reset;
+  UnsafeCommandIdGuard command_id_guard;
+
+  SPI_connect();
+  PushActiveSnapshot(GetTransactionSnapshot());
+
+  auto save_nestlevel = NewGUCNestLevel();
+  SetConfigOption("duckdb.force_execution", "false", PGC_USERSET,
+                  PGC_S_SESSION);
+
+  int ret;
+  if (params) {
+    SPIPlanPtr plan = GetCachedPlan(query, *params);
+    ret = SPI_execute_plan(plan, const_cast<Datum *>(params->values), nullptr,
+                           false, 0);
+  } else {
+    ret = SPI_execute(query.c_str(), false, 0);
+  }
+
+  if (ret < 0) {
+    elog(ERROR, "SPI_execute failed: %s", SPI_result_code_string(ret));
+  }
+
+  auto result = MaterializeSPIResult(ret, SPI_tuptable);
+
+  AtEOXact_GUC(false, save_nestlevel);
+  PopActiveSnapshot();
+  SPI_finish();
+
+  return result;
+}
+
+/*
+ * Snapshot shared by the metadata reads of the current DuckLake transaction,
+ * so a read costs a snapshot copy instead of a fresh GetSnapshotData(). It is
+ * dropped when the last open DuckLake transaction ends, so that under READ
+ * COMMITTED the next one sees commits made in the meantime, and at every
+ * transaction event, in particular at pre-commit: DuckLake commits (and
+ * checks for conflicting commits) from pg_duckdb's pre-commit callback, which
+ * runs after ours, so those reads start from a fresh snapshot.
+ */
+static Snapshot metadata_read_snapshot = nullptr;
+static int metadata_read_scopes = 0;
+
+static void ReleaseMetadataReadSnapshot() {
+  if (metadata_read_snapshot) {
+    UnregisterSnapshotFromOwner(metadata_read_snapshot,
+                                TopTransactionResourceOwner);
+    metadata_read_snapshot = nullptr;
+  }
+}
+
+static void MetadataReadXactCallback(XactEvent /*event*/, void * /*arg*/) {
+  ReleaseMetadataReadSnapshot();
+}
+
+Snapshot GetMetadataReadSnapshot() {
+  static bool xact_callback_registered = false;
+  if (!xact_callback_registered) {
+    RegisterXactCallback(MetadataReadXactCallback, nullptr);
+    xact_callback_registered = true;
+  }
+
+  if (!metadata_read_snapshot) {
+    metadata_read_snapshot = RegisterSnapshotOnOwner(
+        GetTransactionSnapshot(), TopTransactionResourceOwner);
+  }
+  return metadata_read_snapshot;
+}
+
+void BeginMetadataReadScope() { metadata_read_scopes++; }
+
+void EndMetadataReadScope() {
+  if (metadata_read_scopes > 0 && --metadata_read_scopes == 0) {
+    ReleaseMetadataReadSnapshot();
+  }
+}
+
+void PushMetadataReadSnapshot() {
+  PushCopiedSnapshot(GetMetadataReadSnapshot());
+  UpdateActiveSnapshotCommandId();
+}
+
+/*
+ * With duckdb.force_execution on, pg_duckdb would plan our metadata queries
+ * for DuckDB. Turn it off for the duration of the read, but only when it is
+ * actually on: setting it once for the whole transaction (SET LOCAL) would
+ * leak into the user's own statements. Returns the GUC nest level to restore,
+ * or -1 if nothing was changed.
+ */
+static int DisableForceExecution() {
+  const char *force_execution =
+      GetConfigOption("duckdb.force_execution", true, false);
+  if (!force_execution || strcmp(force_execution, "off") == 0) {
+    return -1;
+  }
+
+  auto save_nestlevel = NewGUCNestLevel();
+  SetConfigOption("duckdb.force_execution", "false", PGC_USERSET,
+                  PGC_S_SESSION);
+  return save_nestlevel;
+}
+
+static void RestoreForceExecution(int save_nestlevel) {
+  if (save_nestlevel >= 0) {
+    AtEOXact_GUC(false, save_nestlevel);
+  }
+}
+
+// Whether `node` contains a query, at any depth, that locks rows (FOR UPDATE
+// and the like) or writes through a data-modifying WITH.
+static bool HasRowMarksOrModifyingCTE(Node *node, void *context) {
+  if (node == nullptr) {
+    return false;
+  }
+  if (IsA(node, Query)) {
+    auto *query = castNode(Query, node);
+    if (query->rowMarks != NIL || query->hasModifyingCTE) {
+      return true;
+    }
+    return query_tree_walker(query, HasRowMarksOrModifyingCTE, context, 0);
+  }
+  return expression_tree_walker(node, HasRowMarksOrModifyingCTE, context);
+}
+
+// Whether every statement of `plan` is a plain SELECT, which can run through
+// read-only SPI without bumping the command counter. Row locks and
+// data-modifying CTEs also come as SELECT, but are not read-only.
+static bool IsReadOnlyPlan(SPIPlanPtr plan) {
+  ListCell *lc;
+  foreach (lc, SPI_plan_get_plan_sources(plan)) {
+    auto *plansource = static_cast<CachedPlanSource *>(lfirst(lc));
+    if (plansource->commandTag != CMDTAG_SELECT ||
+        plansource->query_list == NIL) {
+      return false;
+    }
+    ListCell *qlc;
+    foreach (qlc, plansource->query_list) {
+      if (HasRowMarksOrModifyingCTE(static_cast<Node *>(lfirst(qlc)),
+                                    nullptr)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Reads without parameters, such as those of the latest snapshot once their
+// snapshot predicates are rewritten away, are cached by their text as well
+static SPIPlanPtr PrepareRead(const duckdb::string &query,
+                              const SnapshotParams *params) {
+  if (params) {
+    return GetCachedPlan(query, *params);
+  }
+  return GetCachedPlan(query, 0, nullptr);
+}
+
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteSPIRead(const duckdb::string &query, const SnapshotParams *params) {
+  elog(DEBUG1, "Creating SPI result for read: %s", query.c_str());
+
+  PostgresScopedStackReset scoped_stack_reset;
+
+  SPI_connect();
+  SPIPlanPtr plan = PrepareRead(query, params);
+  if (!IsReadOnlyPlan(plan)) {
+    SPI_finish();
+    return ExecuteSPIQuery(query, params);
+  }
+
+  PushMetadataReadSnapshot();
+  auto save_nestlevel = DisableForceExecution();
+
+  int ret = SPI_execute_plan(
+      plan, params ? const_cast<Datum *>(params->values) : nullptr, nullptr,
+      true, 0);
+  if (ret < 0) {
+    elog(ERROR, "SPI_execute_plan failed: %s", SPI_result_code_string(ret));
+  }
+
+  auto result = MaterializeSPIResult(ret, SPI_tuptable);
+
+  RestoreForceExecution(save_nestlevel);
+  PopActiveSnapshot();
+  SPI_finish();
+
+  return result;
+}
+
+/*
+ * SPICursorQueryResult - a QueryResult backed by an open SPI cursor.
+ *
+ * Every FetchRaw() reconnects to SPI, pulls the next STANDARD_VECTOR_SIZE
+ * rows from the portal and converts just that batch, so peak memory stays at
+ * one batch and the first chunk is available before the last row is read.
+ * The portal is looked up by name on every call because it is owned by the
+ * transaction, not by us; it is closed once exhausted or when the result is
+ * destroyed early.
+ */
+class SPICursorQueryResult : public duckdb::QueryResult {
+public:
+  SPICursorQueryResult(duckdb::vector<PostgresColumnConverter> converters_p,
+                       duckdb::vector<duckdb::LogicalType> types_p,
+                       duckdb::vector<duckdb::string> names_p,
+                       duckdb::string portal_name_p)
+      : duckdb::QueryResult(duckdb::QueryResultType::STREAM_RESULT,
+                            duckdb::StatementType::SELECT_STATEMENT,
+                            duckdb::StatementProperties(), std::move(types_p),
+                            std::move(names_p), duckdb::ClientProperties()),
+        converters(std::move(converters_p)),
+        portal_name(std::move(portal_name_p)) {}
+
+  ~SPICursorQueryResult() override {
+    if (exhausted || !IsTransactionState()) {
+      return;
+    }
+    Portal portal = SPI_cursor_find(portal_name.c_str());
+    if (portal) {
+      SPI_cursor_close(portal);
+    }
+  }
+
+  duckdb::string ToString() override {
+    return "[[SPI cursor " + portal_name + "]]\n";
+  }
+
+  duckdb::unique_ptr<duckdb::DataChunk> FetchRaw() override {
+    if (exhausted) {
+      return nullptr;
+    }
+
+    PostgresScopedStackReset scoped_stack_reset;
+
+    SPI_connect();
+    Portal portal = SPI_cursor_find(portal_name.c_str());
+    if (!portal) {
+      elog(ERROR, "DuckLake metadata cursor \"%s\" does not exist",
+           portal_name.c_str());
+    }
+
+    SPI_cursor_fetch(portal, true, STANDARD_VECTOR_SIZE);
+    SPITupleTable *tuptable = SPI_tuptable;
+    uint64 num_rows = SPI_processed;
+
+    duckdb::unique_ptr<duckdb::DataChunk> chunk;
+    if (num_rows > 0) {
+      chunk = duckdb::make_uniq<duckdb::DataChunk>();
+      chunk->Initialize(duckdb::Allocator::DefaultAllocator(), types);
+      InsertSPITupleTableIntoChunk(*chunk, converters, tuptable, 0, num_rows);
+      chunk->SetCardinality(num_rows);
+    }
+    SPI_freetuptable(tuptable);
+
+    if (num_rows < STANDARD_VECTOR_SIZE) {
+      SPI_cursor_close(portal);
+      exhausted = true;
+    }
+    SPI_finish();
+
+    return chunk;
+  }
+
+private:
+  duckdb::vector<PostgresColumnConverter> converters;
+  duckdb::string portal_name;
+  bool exhausted = false;
+};
+
+duckdb::unique_ptr<duckdb::QueryResult>
+OpenSPICursor(const duckdb::string &query, const SnapshotParams *params) {
+  elog(DEBUG1, "Opening SPI cursor for query: %s", query.c_str());
+
+  PostgresScopedStackReset scoped_stack_reset;
+
+  SPI_connect();
+  SPIPlanPtr plan = PrepareRead(query, params);
+  if (!IsReadOnlyPlan(plan) || !SPI_is_cursor_plan(plan)) {
+    SPI_finish();
+    return ExecuteSPIRead(query, params);
+  }
+
+  // The portal keeps its own reference to the snapshot, and the override
+  // only matters while the cursor's query is planned.
+  PushMetadataReadSnapshot();
+  auto save_nestlevel = DisableForceExecution();
+
+  Portal portal = SPI_cursor_open(
+      nullptr, plan, params ? const_cast<Datum *>(params->values) : nullptr,
+      nullptr, true);
+  if (!portal) {
+    elog(ERROR, "SPI_cursor_open failed: %s",
+         SPI_result_code_string(SPI_result));
+  }
+
+  duckdb::vector<PostgresColumnConverter> converters;
+  duckdb::vector<duckdb::LogicalType> types;
+  duckdb::vector<duckdb::string> names;
+  DescribeTupleDesc(portal->tupDesc, converters, types, names);
+  duckdb::string portal_name(portal->name);
+
+  RestoreForceExecution(save_nestlevel);
+  PopActiveSnapshot();
+  SPI_finish();
+
+  return duckdb::make_uniq<SPICursorQueryResult>(
+      std::move(converters), std::move(types), std::move(names),
+      std::move(portal_name));
+}
+
+} // namespace pgducklake
+
+extern "C" {
+
+/*
+ * ducklake_convert_metadata_result(query) - Every value of the result of
+ * `query` as it reaches DuckDB through the SPI bridge: column name, DuckDB
+ * type and value in DuckDB's text form, for tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_convert_metadata_result) {
+  auto *rsinfo = reinterpret_cast<ReturnSetInfo *>(fcinfo->resultinfo);
+  if (!rsinfo || !IsA(rsinfo, ReturnSetInfo) ||
+      !(rsinfo->allowedModes & SFRM_Materialize)) {
+    elog(ERROR, "materialize mode required, but it is not allowed in this "
+                "context");
+  }
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+
+  MemoryContext old_context =
+      MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+  Tuplestorestate *tupstore = tuplestore_begin_heap(true, false, work_mem);
+  rsinfo->returnMode = SFRM_Materialize;
+  rsinfo->setResult = tupstore;
+  rsinfo->setDesc = CreateTupleDescCopy(tupdesc);
+  MemoryContextSwitchTo(old_context);
+
+  duckdb::string query = text_to_cstring(PG_GETARG_TEXT_PP(0));
+  auto result = pgducklake::ExecuteSPIRead(query);
+  for (auto chunk = result->Fetch(); chunk; chunk = result->Fetch()) {
+    for (idx_t row = 0; row < chunk->size(); row++) {
+      for (idx_t col = 0; col < chunk->ColumnCount(); col++) {
+        auto value = chunk->GetValue(col, row);
+        auto type = result->types[col].ToString();
+        auto text = value.ToString();
+        Datum values[3];
+        bool nulls[3] = {false, false, value.IsNull()};
+        values[0] = CStringGetTextDatum(result->names[col].c_str());
+        values[1] = CStringGetTextDatum(type.c_str());
+        values[2] = nulls[2] ? (Datum)0 : CStringGetTextDatum(text.c_str());
+        tuplestore_putvalues(tupstore, rsinfo->setDesc, values, nulls);
+      }
+    }
+  }
+  return (Datum)0;
+}
+
+/*
+ * ducklake_plan_cache_stats() - How many metadata reads this backend ran from
+ * a cached plan, and how many plans it prepared, for tests.
+ */
+DECLARE_PG_FUNCTION(ducklake_plan_cache_stats) {
+  TupleDesc tupdesc;
+  if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+    elog(ERROR, "return type must be a row type");
+  }
+  Datum values[2];
+  bool nulls[2] = {false, false};
+  values[0] = Int64GetDatum(pgducklake::plan_cache_hits);
+  values[1] = Int64GetDatum(pgducklake::plan_cache_prepares);
+  PG_RETURN_DATUM(
+      HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+} // extern "C"
@@ -0,0 +1,63 @@
+SELECT enabled FROM ducklake.catalog_cache_stats;
+
+CREATE TABLE t (a int) USING ducklake;
+
+INSERT INTO t VALUES (1), (2);
+
+SELECT * FROM t ORDER BY a;
+
+SELECT hits AS hits_before FROM ducklake.catalog_cache_stats \gset
+
+-- A new backend finds the catalog in shared memory
+\c
+
+SELECT * FROM t ORDER BY a;
+
+SELECT hits > :hits_before AS shared_hit FROM ducklake.catalog_cache_stats;
+
+-- Catalogs are only left out when larger than the whole cache
+SELECT skipped_stores, entries > 0 AS has_entries
+FROM ducklake.catalog_cache_stats;
+
+-- Later snapshots are patched from the cached catalog
+CREATE TABLE t2 (c int) USING ducklake;
+
+INSERT INTO t VALUES (3);
+
+SELECT refreshes AS refreshes_before, full_loads AS full_loads_before
+FROM ducklake._catalog_loads() \gset
+
+SELECT * FROM t ORDER BY a;
+
+SELECT refreshes > :refreshes_before AS refreshed,
+       full_loads = :full_loads_before AS no_full_load
+FROM ducklake._catalog_loads();
+
+SELECT * FROM t2;
+
+DROP TABLE t2;
+
+-- The catalog in one result
+SELECT section, name, column_type
+FROM ducklake._catalog_for_snapshot(
+    (SELECT max(snapshot_id) FROM ducklake.ducklake_snapshot))
+ORDER BY section, id;
+
+-- Restricted to some objects, as for refreshes; schemas always come along
+SELECT section, name
+FROM ducklake._catalog_for_snapshot(
+    (SELECT max(snapshot_id) FROM ducklake.ducklake_snapshot),
+    table_ids => '{}', view_ids => '{}', partition_table_ids => '{}')
+ORDER BY section, id;
+
+-- Commits publish their snapshot for the transactions that follow
+SELECT tgname FROM pg_trigger
+WHERE tgrelid = 'ducklake.ducklake_snapshot'::regclass;
+
+INSERT INTO t VALUES (4);
+
+\c
+
+SELECT * FROM t ORDER BY a;
+
+DROP TABLE t;
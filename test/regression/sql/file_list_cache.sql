@@ -0,0 +1,62 @@
+CREATE TABLE f (a int) USING ducklake;
+
+INSERT INTO f VALUES (1), (2);
+
+INSERT INTO f VALUES (3), (4);
+
+INSERT INTO f VALUES (5), (6);
+
+INSERT INTO f VALUES (7), (8);
+
+SELECT * FROM f ORDER BY a;
+
+SELECT hits AS hits_before FROM ducklake._file_list_loads() \gset
+
+-- An unchanged table reuses its file list
+SELECT * FROM f ORDER BY a;
+
+SELECT hits > :hits_before AS hit FROM ducklake._file_list_loads();
+
+-- New files and delete files only reread the rows of the files they touch
+SELECT refreshes AS refreshes_before FROM ducklake._file_list_loads() \gset
+
+INSERT INTO f VALUES (9);
+
+DELETE FROM f WHERE a = 2;
+
+SELECT full_reads AS full_reads_before FROM ducklake._file_list_loads() \gset
+
+SELECT * FROM f ORDER BY a;
+
+SELECT refreshes > :refreshes_before AS refreshed,
+       full_reads = :full_reads_before AS no_full_read
+FROM ducklake._file_list_loads();
+
+-- The cache can be turned off; file lists then stream from the metadata tables
+SET ducklake.file_list_cache_size = 0;
+
+SELECT * FROM f ORDER BY a;
+
+-- Streamed file lists of the latest snapshot bind no parameters once their
+-- snapshot predicates are rewritten, and still reuse their plans
+SELECT hits AS plan_hits_before, prepares AS prepares_before
+FROM ducklake._plan_cache_stats() \gset
+
+SELECT * FROM f ORDER BY a;
+
+SELECT hits > :plan_hits_before AS plan_hit,
+       prepares = :prepares_before AS no_prepare
+FROM ducklake._plan_cache_stats();
+
+RESET ducklake.file_list_cache_size;
+
+-- ... as they do in transactions that wrote metadata
+BEGIN;
+
+INSERT INTO f VALUES (10);
+
+SELECT count(*) FROM f;
+
+ROLLBACK;
+
+DROP TABLE f;
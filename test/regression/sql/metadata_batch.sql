@@ -0,0 +1,84 @@
+-- Consecutive INSERTs into the same table become one; nothing is reordered
+SELECT * FROM ducklake._explain_metadata_batch($$
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (1, 1, NULL, 'a', 'x');
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (2, 1, NULL, 'b', 'y');
+INSERT INTO ducklake.ducklake_column_tag (table_id, column_id, begin_snapshot, end_snapshot, key, value) VALUES (1, 1, 1, NULL, 'c', 'z');
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (3, 1, NULL, 'c', 'w');
+UPDATE ducklake.ducklake_tag SET end_snapshot = 2 WHERE object_id = 1;
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (4, 2, NULL, 'd', 'v')
+$$);
+
+-- Semicolons in literals and comments do not end a statement
+SELECT * FROM ducklake._explain_metadata_batch($batch$
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (1, 1, NULL, 'a;b', 'it''s; here'); -- one; two
+/* three; /* nested; */ four; */
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (2, 1, NULL, E'c\';d', $$e;f$$);
+UPDATE ducklake.ducklake_tag SET value = $tag$g;h$tag$ WHERE object_id = $1
+$batch$);
+
+-- Literals the executor would cast are left to it
+SELECT v.literal_row, b.direct
+FROM (VALUES
+    (1, '(1, 1, NULL, ''a'', ''b'')'),
+    (2, '(''1'', ''1'', NULL, ''a'', ''b'')'),
+    (3, '(+1, 1, NULL, ''a'', ''b'')'),
+    (4, '(1, 1, NULL, 5, ''b'')'),
+    (5, '(1.5, 1, NULL, ''a'', ''b'')'),
+    (6, '(1e2, 1, NULL, ''a'', ''b'')'),
+    (7, '(1, 1, NULL, TRUE, ''b'')')) v(n, literal_row),
+    ducklake._explain_metadata_batch(
+        'INSERT INTO ducklake.ducklake_tag VALUES ' || v.literal_row) b
+ORDER BY v.n;
+
+-- Rules and deferred index checks need the executor
+BEGIN;
+
+CREATE RULE ducklake_tag_notify AS ON INSERT TO ducklake.ducklake_tag
+    DO ALSO NOTIFY ducklake_tag;
+
+SELECT direct FROM ducklake._explain_metadata_batch(
+    'INSERT INTO ducklake.ducklake_tag VALUES (1, 1, NULL, ''a'', ''b'')');
+
+ROLLBACK;
+
+BEGIN;
+
+ALTER TABLE ducklake.ducklake_tag
+    ADD UNIQUE (object_id, key, begin_snapshot) DEFERRABLE;
+
+SELECT direct FROM ducklake._explain_metadata_batch(
+    'INSERT INTO ducklake.ducklake_tag VALUES (1, 1, NULL, ''a'', ''b'')');
+
+ROLLBACK;
+
+-- Direct appends maintain every index, are seen by the rest of the batch, and
+-- fail on duplicate keys as the executor would
+BEGIN;
+
+CREATE UNIQUE INDEX ducklake_tag_test_key
+    ON ducklake.ducklake_tag (object_id, key, begin_snapshot);
+
+SELECT ducklake._execute_metadata_batch($$
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (-1, 1, NULL, 'a', 'x');
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (-2, 1, NULL, 'b', 'y');
+UPDATE ducklake.ducklake_tag SET end_snapshot = 2 WHERE object_id = -1;
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (-1, 2, NULL, 'a', 'z')
+$$);
+
+SELECT * FROM ducklake.ducklake_tag WHERE object_id < 0
+ORDER BY object_id, begin_snapshot;
+
+-- Current rows through the partial index
+SET LOCAL enable_seqscan = off;
+
+SET LOCAL enable_bitmapscan = off;
+
+SELECT object_id, value FROM ducklake.ducklake_tag
+WHERE object_id < 0 AND end_snapshot IS NULL ORDER BY object_id;
+
+SELECT ducklake._execute_metadata_batch($$
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (-3, 1, NULL, 'c', 'w');
+INSERT INTO ducklake.ducklake_tag (object_id, begin_snapshot, end_snapshot, key, value) VALUES (-2, 1, NULL, 'b', 'w')
+$$);
+
+ROLLBACK;
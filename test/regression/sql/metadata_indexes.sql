@@ -0,0 +1,117 @@
+-- The metadata manager's own queries, planned over a metadata history much
+-- larger than the current state, must not go through all of that history: no
+-- sequential scans of the tables that grow with it. Each query is prepared
+-- with the parameters the manager binds, and its plan for `args` explained.
+CREATE FUNCTION pg_temp.seq_scans(query text, types text, args text)
+    RETURNS SETOF text
+    LANGUAGE plpgsql AS $$
+DECLARE
+    plan jsonb;
+BEGIN
+    EXECUTE format('PREPARE probe(%s) AS %s', types, query);
+    EXECUTE format('EXPLAIN (FORMAT JSON) EXECUTE probe(%s)', args) INTO plan;
+    EXECUTE 'DEALLOCATE probe';
+    RETURN QUERY
+        SELECT DISTINCT node ->> 'Relation Name'
+        FROM jsonb_path_query(plan, 'strict $.**') AS node
+        WHERE node ->> 'Node Type' = 'Seq Scan'
+          AND node ->> 'Relation Name' IN (
+              'ducklake_table', 'ducklake_column', 'ducklake_tag',
+              'ducklake_column_tag', 'ducklake_data_file')
+        ORDER BY 1;
+END
+$$;
+
+CREATE TABLE t (a int) USING ducklake;
+
+INSERT INTO t VALUES (1);
+
+-- Leaves the file list query of t in the cache
+SELECT * FROM t;
+
+SELECT max(snapshot_id) AS latest FROM ducklake.ducklake_snapshot \gset
+
+SELECT DISTINCT name FROM ducklake._metadata_read_queries() ORDER BY name;
+
+BEGIN;
+
+-- 10000 tables dropped long ago, with their columns, tags and files
+INSERT INTO ducklake.ducklake_table
+    (table_id, table_uuid, begin_snapshot, end_snapshot, schema_id,
+     table_name)
+SELECT 1000000 + i, gen_random_uuid(), 0, 0, 0, 'dropped_' || i
+FROM generate_series(1, 10000) i;
+
+INSERT INTO ducklake.ducklake_column
+    (column_id, begin_snapshot, end_snapshot, table_id, column_order,
+     column_name, column_type, nulls_allowed)
+SELECT j, 0, 0, 1000000 + i, j, 'c' || j, 'int32', true
+FROM generate_series(1, 10000) i, generate_series(1, 5) j;
+
+INSERT INTO ducklake.ducklake_tag
+    (object_id, begin_snapshot, end_snapshot, key, value)
+SELECT 1000000 + i, 0, 0, 'comment', 'dropped'
+FROM generate_series(1, 10000) i;
+
+INSERT INTO ducklake.ducklake_column_tag
+    (table_id, column_id, begin_snapshot, end_snapshot, key, value)
+SELECT 1000000 + i, 1, 0, 0, 'comment', 'dropped'
+FROM generate_series(1, 10000) i;
+
+INSERT INTO ducklake.ducklake_data_file
+    (data_file_id, table_id, begin_snapshot, end_snapshot, path,
+     path_is_relative, file_format, record_count, file_size_bytes,
+     footer_size)
+SELECT 1000000 + i, 1000000 + i % 100, 0, 0, 'f' || i || '.parquet', true,
+       'parquet', 1, 1, 1
+FROM generate_series(1, 10000) i;
+
+ANALYZE ducklake.ducklake_table, ducklake.ducklake_column,
+    ducklake.ducklake_tag, ducklake.ducklake_column_tag,
+    ducklake.ducklake_data_file;
+
+-- Catalog of the latest snapshot, and of an older one
+SELECT * FROM pg_temp.seq_scans(
+    'SELECT * FROM ducklake._catalog_for_snapshot($1)',
+    'bigint, bigint, bigint, bigint', format('%s, 0, 0, 0', :latest));
+
+SELECT * FROM pg_temp.seq_scans(
+    'SELECT * FROM ducklake._catalog_for_snapshot($1)',
+    'bigint, bigint, bigint, bigint', format('%s, 0, 0, 0', :latest - 1));
+
+-- Changed objects, as read by a refresh
+SELECT * FROM pg_temp.seq_scans(
+    'SELECT * FROM ducklake._catalog_for_snapshot($1, table_ids => $5, '
+    'view_ids => $6, partition_table_ids => $7)',
+    'bigint, bigint, bigint, bigint, bigint[], bigint[], bigint[]',
+    format('%s, 0, 0, 0, %L, %L, %L', :latest, '{1}', '{}', '{}'));
+
+-- Objects changed between two snapshots. This plan is cached, and cheap
+-- enough to go generic, so that plan is checked as well.
+SELECT query AS changes_query FROM ducklake._metadata_read_queries()
+WHERE name = 'catalog_changes' \gset
+
+SELECT * FROM pg_temp.seq_scans(:'changes_query',
+    'bigint, bigint, bigint, bigint, bigint, bigint',
+    format('%s, 0, 0, 0, %s, %s', :latest, :latest - 1, :latest));
+
+SET plan_cache_mode = force_generic_plan;
+
+SELECT * FROM pg_temp.seq_scans(:'changes_query',
+    'bigint, bigint, bigint, bigint, bigint, bigint',
+    format('%s, 0, 0, 0, %s, %s', :latest, :latest - 1, :latest));
+
+RESET plan_cache_mode;
+
+-- File lists, at the latest snapshot and at an older one
+SELECT name, seq_scan
+FROM ducklake._metadata_read_queries(),
+     pg_temp.seq_scans(query, 'bigint, bigint, bigint, bigint',
+         format('%s, 0, 0, 0',
+                CASE name WHEN 'file_list_latest' THEN :latest
+                          ELSE :latest - 1 END)) AS seq_scan
+WHERE name LIKE 'file_list%';
+
+ROLLBACK;
+
+DROP TABLE t;
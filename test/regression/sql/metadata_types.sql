@@ -0,0 +1,28 @@
+-- money keeps all of its int64 range
+SELECT * FROM ducklake._convert_metadata_result($$
+SELECT '92233720368547758.07'::money AS max_money,
+       '-92233720368547758.08'::money AS min_money,
+       '1.5'::money AS money
+$$);
+
+-- Intervals keep their fields; infinite ones (PostgreSQL 17) become NULL
+SELECT * FROM ducklake._convert_metadata_result($$
+SELECT '1 year 2 mons 3 days 04:05:06.5'::interval AS i,
+       '-1 mons -1 days'::interval AS negative
+$$);
+
+SELECT * FROM ducklake._convert_metadata_result(
+  CASE WHEN current_setting('server_version_num')::int >= 170000
+    THEN $$SELECT 'infinity'::interval AS i, '-infinity'::interval AS j$$
+    ELSE $$SELECT NULL::interval AS i, NULL::interval AS j$$
+  END);
+
+-- Other built-in types with a native conversion
+SELECT * FROM ducklake._convert_metadata_result($$
+SELECT '\x0102'::bytea AS bytes,
+       '12:34:56+02'::timetz AS timetz,
+       '12:34:56'::time AS time,
+       'a'::"char" AS c,
+       42::oid AS oid,
+       '192.168.0.1/24'::inet AS inet
+$$);
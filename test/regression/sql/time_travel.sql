@@ -0,0 +1,19 @@
+-- Reads of older snapshots see rows that have ended since
+CREATE TABLE tt (a int) USING ducklake;
+
+INSERT INTO tt VALUES (1), (2);
+
+SELECT max(snapshot_id) AS v1 FROM ducklake.ducklake_snapshot \gset
+
+INSERT INTO tt VALUES (3);
+
+SELECT * FROM tt ORDER BY a;
+
+SELECT * FROM duckdb.query(format(
+  'SELECT a FROM pgducklake.main.tt AT (VERSION => %s) ORDER BY a', :v1));
+
+-- A dropped table is still there at the snapshots it was part of
+DROP TABLE tt;
+
+SELECT * FROM duckdb.query(format(
+  'SELECT a FROM pgducklake.main.tt AT (VERSION => %s) ORDER BY a', :v1));
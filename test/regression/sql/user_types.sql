@@ -0,0 +1,29 @@
+CREATE TYPE mood AS ENUM ('sad', 'ok', 'happy');
+
+CREATE TYPE pair AS (x int, y text);
+
+-- Enums become VARCHAR, as DuckLake has no ENUM columns, and composites
+-- STRUCTs, also inside arrays
+CREATE TABLE ut (id int, m mood, p pair, ms mood[]) USING ducklake;
+
+INSERT INTO ut VALUES
+    (1, 'happy', ROW(1, 'a'), ARRAY['sad', 'ok']::mood[]),
+    (2, 'sad', ROW(2, 'b'), NULL);
+
+SELECT * FROM ut ORDER BY id;
+
+-- Stored as text, enum values sort by their text
+SELECT m, count(*) FROM ut GROUP BY m ORDER BY m;
+
+-- Labels added later can be stored right away
+ALTER TYPE mood ADD VALUE 'angry';
+
+INSERT INTO ut VALUES (3, 'angry', ROW(3, 'c'), ARRAY['angry']::mood[]);
+
+SELECT id, m, ms FROM ut ORDER BY id;
+
+DROP TABLE ut;
+
+DROP TYPE pair;
+
+DROP TYPE mood;